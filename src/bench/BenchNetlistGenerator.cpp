@@ -0,0 +1,437 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "BenchNetlistGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "NLDB.h"
+#include "NLLibrary.h"
+#include "SNLDesign.h"
+#include "SNLDesignModeling.h"
+#include "SNLInstTerm.h"
+#include "SNLInstance.h"
+#include "SNLScalarNet.h"
+#include "SNLScalarTerm.h"
+
+using namespace naja::NL;
+using namespace KEPLER_FORMAL;
+
+namespace {
+
+// Logic depth of the random clouds: it bounds the per-output cone trees
+// expanded by SNLLogicCloud while the width carries the instance count.
+constexpr size_t kRandomDepth = 10;
+// Pipeline stages, each a random cloud closed by a register bank
+constexpr size_t kPipelineStages = 8;
+// Data inputs shared by the mux trees, one 64:1 tree is 63 MUX2s
+constexpr size_t kMuxDataInputs = 64;
+constexpr size_t kMuxSelects = 6;
+
+}  // namespace
+
+BenchNetlistGenerator::BenchNetlistGenerator(NLDB* db) {
+  primitives_ =
+      NLLibrary::create(db, NLLibrary::Type::Primitives, NLName("BENCH_PRIMS"));
+  designs_ = NLLibrary::create(db, NLName("BENCH"));
+  createPrimitives();
+}
+
+void BenchNetlistGenerator::createPrimitives() {
+  auto createGate = [&](const char* name, size_t numInputs, uint64_t mask) {
+    auto model = SNLDesign::create(primitives_, SNLDesign::Type::Primitive,
+                                   NLName(name));
+    static const char* inputNames[] = {"A", "B", "S"};
+    for (size_t i = 0; i < numInputs; ++i) {
+      SNLScalarTerm::create(model, SNLTerm::Direction::Input,
+                            NLName(inputNames[i]));
+    }
+    SNLScalarTerm::create(model, SNLTerm::Direction::Output, NLName("Y"));
+    SNLDesignModeling::setTruthTable(model, SNLTruthTable(numInputs, mask));
+    return model;
+  };
+  inv_ = createGate("INV", 1, 1);
+  and2_ = createGate("AND2", 2, 8);
+  or2_ = createGate("OR2", 2, 0xE);
+  nand2_ = createGate("NAND2", 2, 7);
+  nor2_ = createGate("NOR2", 2, 1);
+  xor2_ = createGate("XOR2", 2, 6);
+  // inputs (A, B, S): S ? B : A
+  mux2_ = createGate("MUX2", 3, 0xCA);
+
+  dff_ = SNLDesign::create(primitives_, SNLDesign::Type::Primitive,
+                           NLName("DFF"));
+  auto d = SNLScalarTerm::create(dff_, SNLTerm::Direction::Input, NLName("D"));
+  auto clk =
+      SNLScalarTerm::create(dff_, SNLTerm::Direction::Input, NLName("CLK"));
+  auto q = SNLScalarTerm::create(dff_, SNLTerm::Direction::Output, NLName("Q"));
+  SNLDesignModeling::addInputsToClockArcs({d}, {clk});
+  SNLDesignModeling::addClockToOutputsArcs({clk}, {q});
+}
+
+bool BenchNetlistGenerator::parseKind(const std::string& name, Kind& kind) {
+  if (name == "adder") {
+    kind = Kind::Adder;
+  } else if (name == "multiplier") {
+    kind = Kind::Multiplier;
+  } else if (name == "mux") {
+    kind = Kind::MuxTree;
+  } else if (name == "random") {
+    kind = Kind::RandomLogic;
+  } else if (name == "pipeline") {
+    kind = Kind::Pipeline;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const char* BenchNetlistGenerator::getKindName(Kind kind) {
+  switch (kind) {
+    case Kind::Adder:
+      return "adder";
+    case Kind::Multiplier:
+      return "multiplier";
+    case Kind::MuxTree:
+      return "mux";
+    case Kind::RandomLogic:
+      return "random";
+    case Kind::Pipeline:
+      return "pipeline";
+  }
+  // LCOV_EXCL_START
+  return "unknown";
+  // LCOV_EXCL_STOP
+}
+
+uint64_t BenchNetlistGenerator::nextRandom() {
+  // splitmix64: fixed sequence on every platform, unlike std distributions
+  uint64_t z = (rngState_ += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+SNLDesign* BenchNetlistGenerator::generate(Kind kind,
+                                           size_t size,
+                                           uint64_t seed,
+                                           int variant,
+                                           const std::string& name) {
+  top_ = SNLDesign::create(designs_, NLName(name));
+  variant_ = variant;
+  rngState_ = seed;
+  numInstances_ = 0;
+  numNets_ = 0;
+  numOutputs_ = 0;
+  size = std::max<size_t>(size, 1);
+  switch (kind) {
+    case Kind::Adder:
+      generateAdder(size);
+      break;
+    case Kind::Multiplier:
+      generateMultiplier(size);
+      break;
+    case Kind::MuxTree:
+      generateMuxTree(size);
+      break;
+    case Kind::RandomLogic:
+      generateRandomLogic(size);
+      break;
+    case Kind::Pipeline:
+      generatePipeline(size);
+      break;
+  }
+  return top_;
+}
+
+BenchNetlistGenerator::Signal BenchNetlistGenerator::createInput(
+    const std::string& name) {
+  auto term =
+      SNLScalarTerm::create(top_, SNLTerm::Direction::Input, NLName(name));
+  auto net = SNLScalarNet::create(top_, NLName(name));
+  term->setNet(net);
+  return net;
+}
+
+void BenchNetlistGenerator::createOutput(const std::string& name, Signal s) {
+  auto term =
+      SNLScalarTerm::create(top_, SNLTerm::Direction::Output, NLName(name));
+  term->setNet(s);
+  ++numOutputs_;
+}
+
+BenchNetlistGenerator::Signal BenchNetlistGenerator::createCell(
+    SNLDesign* model,
+    const std::vector<Signal>& inputs,
+    const std::string& name) {
+  auto inst = SNLInstance::create(
+      top_, model,
+      NLName(name.empty() ? "g" + std::to_string(numInstances_) : name));
+  ++numInstances_;
+  auto out = SNLScalarNet::create(top_, NLName("n" + std::to_string(numNets_++)));
+  size_t i = 0;
+  for (auto term : model->getBitTerms()) {
+    if (term->getDirection() == SNLTerm::Direction::Output) {
+      inst->getInstTerm(term)->setNet(out);
+    } else {
+      inst->getInstTerm(term)->setNet(inputs[i++]);
+    }
+  }
+  return out;
+}
+
+BenchNetlistGenerator::Signal BenchNetlistGenerator::createDFF(
+    Signal d,
+    Signal clk,
+    const std::string& name) {
+  // Register names are shared by both variants: the miter pairs the
+  // sequential boundary terms by instance path.
+  return createCell(dff_, {d, clk}, name);
+}
+
+BenchNetlistGenerator::Signal BenchNetlistGenerator::emit(Op op,
+                                                          Signal a,
+                                                          Signal b,
+                                                          Signal s) {
+  if (variant_ == 0) {
+    switch (op) {
+      case Op::Not:
+        return createCell(inv_, {a});
+      case Op::And:
+        return createCell(and2_, {a, b});
+      case Op::Or:
+        return createCell(or2_, {a, b});
+      case Op::Xor:
+        return createCell(xor2_, {a, b});
+      case Op::Mux:
+        return createCell(mux2_, {a, b, s});
+    }
+  }
+  switch (op) {
+    case Op::Not:
+      return createCell(inv_, {a});
+    case Op::And:
+      return createCell(nor2_, {createCell(inv_, {a}), createCell(inv_, {b})});
+    case Op::Or:
+      return createCell(nand2_,
+                        {createCell(inv_, {a}), createCell(inv_, {b})});
+    case Op::Xor: {
+      Signal n = createCell(nand2_, {a, b});
+      return createCell(nand2_, {createCell(nand2_, {a, n}),
+                                 createCell(nand2_, {b, n})});
+    }
+    case Op::Mux:
+      return createCell(nand2_, {createCell(nand2_, {a, createCell(inv_, {s})}),
+                                 createCell(nand2_, {b, s})});
+  }
+  // LCOV_EXCL_START
+  throw std::logic_error("BenchNetlistGenerator: unknown operation");
+  // LCOV_EXCL_STOP
+}
+
+BenchNetlistGenerator::Signal BenchNetlistGenerator::addBit(Signal a,
+                                                            Signal b,
+                                                            Signal& carry) {
+  if (a == nullptr) std::swap(a, b);
+  if (a == nullptr) {
+    Signal sum = carry;
+    carry = nullptr;
+    return sum;
+  }
+  if (b == nullptr) std::swap(b, carry);
+  if (b == nullptr) {
+    return a;
+  }
+  Signal p = emit(Op::Xor, a, b);
+  Signal g = emit(Op::And, a, b);
+  if (carry == nullptr) {
+    carry = g;
+    return p;
+  }
+  Signal sum = emit(Op::Xor, p, carry);
+  carry = emit(Op::Or, g, emit(Op::And, p, carry));
+  return sum;
+}
+
+void BenchNetlistGenerator::generateAdder(size_t size) {
+  // ripple-carry: five cells per bit
+  const size_t width = std::max<size_t>(size / 5, 1);
+  std::vector<Signal> a, b;
+  for (size_t i = 0; i < width; ++i) {
+    a.push_back(createInput("a" + std::to_string(i)));
+    b.push_back(createInput("b" + std::to_string(i)));
+  }
+  Signal carry = createInput("cin");
+  for (size_t i = 0; i < width; ++i) {
+    createOutput("s" + std::to_string(i), addBit(a[i], b[i], carry));
+  }
+  createOutput("cout", carry);
+}
+
+void BenchNetlistGenerator::generateMultiplier(size_t size) {
+  // array multiplier: W^2 partial products reduced by W-1 ripple adders,
+  // about six cells per partial product
+  const size_t width = std::max<size_t>(
+      static_cast<size_t>(std::sqrt(static_cast<double>(size) / 6.0)), 2);
+  std::vector<Signal> a, b;
+  for (size_t i = 0; i < width; ++i) {
+    a.push_back(createInput("a" + std::to_string(i)));
+  }
+  for (size_t i = 0; i < width; ++i) {
+    b.push_back(createInput("b" + std::to_string(i)));
+  }
+  auto partialProducts = [&](size_t row) {
+    std::vector<Signal> pp;
+    for (size_t j = 0; j < width; ++j) {
+      pp.push_back(emit(Op::And, a[j], b[row]));
+    }
+    return pp;
+  };
+  size_t numProducts = 0;
+  std::vector<Signal> acc = partialProducts(0);
+  createOutput("p" + std::to_string(numProducts++), acc[0]);
+  Signal top = nullptr;  // carry out of the previous row, null is 0
+  for (size_t row = 1; row < width; ++row) {
+    std::vector<Signal> pp = partialProducts(row);
+    std::vector<Signal> next;
+    Signal carry = nullptr;
+    for (size_t j = 0; j < width; ++j) {
+      Signal hi = j + 1 < width ? acc[j + 1] : top;
+      next.push_back(addBit(hi, pp[j], carry));
+    }
+    createOutput("p" + std::to_string(numProducts++), next[0]);
+    acc = std::move(next);
+    top = carry;
+  }
+  for (size_t j = 1; j < width; ++j) {
+    createOutput("p" + std::to_string(numProducts++), acc[j]);
+  }
+  if (top != nullptr) {
+    createOutput("p" + std::to_string(numProducts++), top);
+  }
+}
+
+void BenchNetlistGenerator::generateMuxTree(size_t size) {
+  // 64:1 trees over shared data inputs, each with its own selects and a
+  // rotated leaf order
+  const size_t numTrees = std::max<size_t>(size / (kMuxDataInputs - 1), 1);
+  std::vector<Signal> data;
+  for (size_t i = 0; i < kMuxDataInputs; ++i) {
+    data.push_back(createInput("d" + std::to_string(i)));
+  }
+  for (size_t t = 0; t < numTrees; ++t) {
+    const size_t rotation = nextRandom() % kMuxDataInputs;
+    std::vector<Signal> level;
+    for (size_t i = 0; i < kMuxDataInputs; ++i) {
+      level.push_back(data[(i + rotation) % kMuxDataInputs]);
+    }
+    for (size_t k = 0; k < kMuxSelects; ++k) {
+      Signal sel =
+          createInput("s" + std::to_string(t) + "_" + std::to_string(k));
+      std::vector<Signal> next;
+      for (size_t i = 0; i + 1 < level.size(); i += 2) {
+        next.push_back(emit(Op::Mux, level[i], level[i + 1], sel));
+      }
+      level = std::move(next);
+    }
+    createOutput("y" + std::to_string(t), level.front());
+  }
+}
+
+std::vector<BenchNetlistGenerator::Signal>
+BenchNetlistGenerator::generateRandomCloud(const std::vector<Signal>& sources,
+                                           size_t numGates) {
+  // Levelized: a gate reads the previous level and, one time in eight, any
+  // source. The draws do not depend on the variant, so both variants get
+  // the same function.
+  const size_t width = std::max<size_t>(numGates / kRandomDepth, 1);
+  std::vector<Signal> previous = sources;
+  std::vector<bool> previousUsed(previous.size(), false);
+  std::vector<Signal> dangling;
+  auto pick = [&]() {
+    if (nextRandom() % 8 == 0) {
+      return sources[nextRandom() % sources.size()];
+    }
+    const size_t i = nextRandom() % previous.size();
+    previousUsed[i] = true;
+    return previous[i];
+  };
+  for (size_t level = 0; level < kRandomDepth; ++level) {
+    std::vector<Signal> current;
+    for (size_t i = 0; i < width; ++i) {
+      const uint64_t draw = nextRandom() % 8;
+      if (draw == 0) {
+        current.push_back(emit(Op::Not, pick()));
+      } else if (draw < 3) {
+        Signal x = pick();
+        current.push_back(emit(Op::And, x, pick()));
+      } else if (draw < 5) {
+        Signal x = pick();
+        current.push_back(emit(Op::Or, x, pick()));
+      } else if (draw < 7) {
+        Signal x = pick();
+        current.push_back(emit(Op::Xor, x, pick()));
+      } else {
+        Signal x = pick();
+        Signal y = pick();
+        current.push_back(emit(Op::Mux, x, y, pick()));
+      }
+    }
+    if (level > 0) {
+      for (size_t i = 0; i < previous.size(); ++i) {
+        if (!previousUsed[i]) dangling.push_back(previous[i]);
+      }
+    }
+    previous = std::move(current);
+    previousUsed.assign(previous.size(), false);
+  }
+  dangling.insert(dangling.end(), previous.begin(), previous.end());
+  return dangling;
+}
+
+void BenchNetlistGenerator::generateRandomLogic(size_t size) {
+  const size_t numInputs = std::max<size_t>(
+      static_cast<size_t>(std::sqrt(static_cast<double>(size))), 8);
+  std::vector<Signal> inputs;
+  for (size_t i = 0; i < numInputs; ++i) {
+    inputs.push_back(createInput("i" + std::to_string(i)));
+  }
+  size_t numOutputs = 0;
+  for (Signal s : generateRandomCloud(inputs, size)) {
+    createOutput("o" + std::to_string(numOutputs++), s);
+  }
+}
+
+void BenchNetlistGenerator::generatePipeline(size_t size) {
+  // stages of random logic; every signal a stage leaves unread is captured
+  // by the register bank feeding the next stage
+  const size_t stages = std::min<size_t>(kPipelineStages,
+                                         std::max<size_t>(size / 64, 1));
+  const size_t numInputs = std::max<size_t>(
+      static_cast<size_t>(std::sqrt(static_cast<double>(size / stages))), 8);
+  Signal clk = createInput("clk");
+  std::vector<Signal> sources;
+  for (size_t i = 0; i < numInputs; ++i) {
+    sources.push_back(createInput("i" + std::to_string(i)));
+  }
+  // a register is about one gate of budget
+  const size_t gatesPerStage = std::max<size_t>(size / stages * 9 / 10, 1);
+  for (size_t stage = 0; stage < stages; ++stage) {
+    std::vector<Signal> signals = generateRandomCloud(sources, gatesPerStage);
+    if (stage + 1 == stages) {
+      size_t numOutputs = 0;
+      for (Signal s : signals) {
+        createOutput("o" + std::to_string(numOutputs++), s);
+      }
+      break;
+    }
+    sources.clear();
+    for (size_t i = 0; i < signals.size(); ++i) {
+      sources.push_back(createDFF(
+          signals[i], clk,
+          "r" + std::to_string(stage) + "_" + std::to_string(i)));
+    }
+  }
+}
@@ -0,0 +1,96 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace naja {
+namespace NL {
+class NLDB;
+class NLLibrary;
+class SNLDesign;
+class SNLNet;
+}  // namespace NL
+}  // namespace naja
+
+namespace KEPLER_FORMAL {
+
+/// Deterministic generator of flat SNL benchmark netlists, built directly
+/// through the naja API on a small primitive library (INV, AND2, OR2, NAND2,
+/// NOR2, XOR2, MUX2, DFF).
+///
+/// Variant 0 maps each logic operation to its own cell. Variant 1 computes
+/// the same function from NAND/NOR/INV decompositions, so a miter between
+/// the two variants is not closed by structural hashing alone.
+class BenchNetlistGenerator {
+ public:
+  enum class Kind { Adder, Multiplier, MuxTree, RandomLogic, Pipeline };
+
+  explicit BenchNetlistGenerator(naja::NL::NLDB* db);
+
+  // Builds a top design of about `size` variant-0 instances. The same
+  // (kind, size, seed) always yields the same netlist.
+  naja::NL::SNLDesign* generate(Kind kind,
+                                size_t size,
+                                uint64_t seed,
+                                int variant,
+                                const std::string& name);
+  // Instances created by the last generate() call
+  size_t getNumInstances() const { return numInstances_; }
+
+  static bool parseKind(const std::string& name, Kind& kind);
+  static const char* getKindName(Kind kind);
+
+ private:
+  using Signal = naja::NL::SNLNet*;
+  enum class Op { Not, And, Or, Xor, Mux };
+
+  void createPrimitives();
+  Signal createInput(const std::string& name);
+  void createOutput(const std::string& name, Signal s);
+  Signal createCell(naja::NL::SNLDesign* model,
+                    const std::vector<Signal>& inputs,
+                    const std::string& name = "");
+  Signal createDFF(Signal d, Signal clk, const std::string& name);
+  // Emits op(a, b, s) with the cells of the current variant; Mux is s ? b : a
+  Signal emit(Op op, Signal a, Signal b = nullptr, Signal s = nullptr);
+  // Full adder where a null operand stands for constant 0; returns the sum,
+  // carry is updated (null when constant 0)
+  Signal addBit(Signal a, Signal b, Signal& carry);
+  uint64_t nextRandom();
+
+  void generateAdder(size_t size);
+  void generateMultiplier(size_t size);
+  void generateMuxTree(size_t size);
+  // Random gates over `sources`, each reading from a sliding window of recent
+  // signals; returns the signals without fanout, oldest first
+  std::vector<Signal> generateRandomCloud(const std::vector<Signal>& sources,
+                                          size_t numGates);
+  void generateRandomLogic(size_t size);
+  void generatePipeline(size_t size);
+
+  naja::NL::NLLibrary* primitives_ = nullptr;
+  naja::NL::NLLibrary* designs_ = nullptr;
+  naja::NL::SNLDesign* inv_ = nullptr;
+  naja::NL::SNLDesign* and2_ = nullptr;
+  naja::NL::SNLDesign* or2_ = nullptr;
+  naja::NL::SNLDesign* nand2_ = nullptr;
+  naja::NL::SNLDesign* nor2_ = nullptr;
+  naja::NL::SNLDesign* xor2_ = nullptr;
+  naja::NL::SNLDesign* mux2_ = nullptr;
+  naja::NL::SNLDesign* dff_ = nullptr;
+
+  // state of the design being generated
+  naja::NL::SNLDesign* top_ = nullptr;
+  int variant_ = 0;
+  uint64_t rngState_ = 0;
+  size_t numInstances_ = 0;
+  size_t numNets_ = 0;
+  size_t numOutputs_ = 0;
+};
+
+}  // namespace KEPLER_FORMAL
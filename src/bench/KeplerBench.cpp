@@ -0,0 +1,316 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+// kepler_bench: times the equivalence pipeline phases on generated netlists
+// of known size, one tab-separated line per phase so nightly runs can be
+// diffed and plotted.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "AIG.h"
+#include "AIGCnf.h"
+#include "AIGMiter.h"
+#include "BenchNetlistGenerator.h"
+#include "BuildPrimaryOutputClauses.h"
+#include "Concurrency.h"
+#include "PerfReport.h"
+#include "DNL.h"
+#include "MiterStrategy.h"
+#include "NLDB.h"
+#include "NLUniverse.h"
+#include "SNLLogicCloud.h"
+#include "SNLLogicDAG.h"
+#include "Tree2BoolExpr.h"
+
+#include "core/SolverTypes.h"
+#include "simp/SimpSolver.h"
+
+using namespace naja::NL;
+using namespace KEPLER_FORMAL;
+
+namespace {
+
+// Output cones expanded by the SNLLogicCloud phase: the truth-table trees
+// are not shared between outputs, so all of them would dominate the run.
+constexpr size_t kDefaultCloudOutputs = 64;
+
+struct BenchOptions {
+  std::vector<BenchNetlistGenerator::Kind> kinds;
+  std::vector<size_t> sizes;
+  uint64_t seed = 1;
+  size_t cloudOutputs = kDefaultCloudOutputs;
+  bool runMiter = true;
+  size_t threads = 0;
+  std::string perfReportFile;
+};
+
+class PhaseReporter {
+ public:
+  PhaseReporter(const char* kind, size_t size) : kind_(kind), size_(size) {}
+  void setInstances(size_t instances) { instances_ = instances; }
+  // Seconds since the previous call (or construction)
+  double lap() {
+    auto now = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>(now - start_).count();
+    start_ = now;
+    return seconds;
+  }
+  void report(const char* phase, double seconds, const std::string& detail) {
+    std::printf("%s\t%zu\t%zu\t%s\t%.6f\t%s\n", kind_, size_, instances_,
+                phase, seconds, detail.c_str());
+    std::fflush(stdout);
+    PerfReport::record(phase, seconds,
+                       {{"size", static_cast<double>(size_)},
+                        {"instances", static_cast<double>(instances_)}});
+  }
+  void report(const char* phase, const std::string& detail = "") {
+    report(phase, lap(), detail);
+  }
+
+ private:
+  const char* kind_;
+  size_t size_;
+  size_t instances_ = 0;
+  std::chrono::steady_clock::time_point start_ =
+      std::chrono::steady_clock::now();
+};
+
+void printUsage(const char* prog) {
+  std::printf(
+      "Usage: %s [--kind adder|multiplier|mux|random|pipeline|all]\n"
+      "          [--size N[,N...]] [--seed S] [--cloud-outputs N] "
+      "[--threads N] [--no-miter]\n"
+      "          [--perf-report FILE]\n",
+      prog);
+}
+
+bool parseSizes(const std::string& arg, std::vector<size_t>& sizes) {
+  size_t pos = 0;
+  while (pos <= arg.size()) {
+    size_t end = arg.find(',', pos);
+    if (end == std::string::npos) end = arg.size();
+    const std::string item = arg.substr(pos, end - pos);
+    char* last = nullptr;
+    const unsigned long long value = std::strtoull(item.c_str(), &last, 10);
+    if (item.empty() || *last != '\0' || value == 0) {
+      return false;
+    }
+    sizes.push_back(static_cast<size_t>(value));
+    pos = end + 1;
+  }
+  return true;
+}
+
+bool parseOptions(int argc, char** argv, BenchOptions& options) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (a == "--kind" && hasValue) {
+      const std::string kind = argv[++i];
+      if (kind == "all") {
+        options.kinds = {BenchNetlistGenerator::Kind::Adder,
+                         BenchNetlistGenerator::Kind::Multiplier,
+                         BenchNetlistGenerator::Kind::MuxTree,
+                         BenchNetlistGenerator::Kind::RandomLogic,
+                         BenchNetlistGenerator::Kind::Pipeline};
+      } else {
+        BenchNetlistGenerator::Kind k;
+        if (!BenchNetlistGenerator::parseKind(kind, k)) return false;
+        options.kinds.push_back(k);
+      }
+    } else if (a == "--size" && hasValue) {
+      if (!parseSizes(argv[++i], options.sizes)) return false;
+    } else if (a == "--seed" && hasValue) {
+      options.seed = std::strtoull(argv[++i], nullptr, 10);
+    } else if (a == "--cloud-outputs" && hasValue) {
+      options.cloudOutputs = std::strtoull(argv[++i], nullptr, 10);
+    } else if (a == "--threads" && hasValue) {
+      options.threads = std::strtoull(argv[++i], nullptr, 10);
+    } else if (a == "--perf-report" && hasValue) {
+      options.perfReportFile = argv[++i];
+    } else if (a == "--no-miter") {
+      options.runMiter = false;
+    } else {
+      return false;
+    }
+  }
+  if (options.kinds.empty()) {
+    options.kinds.push_back(BenchNetlistGenerator::Kind::RandomLogic);
+  }
+  if (options.sizes.empty()) {
+    options.sizes = {1000, 10000, 100000};
+  }
+  return true;
+}
+
+// Builds the PO literals of the current top design into aig, the way the
+// miter does, after the inputs and outputs were normalized
+void buildDesign(SNLDesign* top,
+                 BuildPrimaryOutputClauses& builder,
+                 const std::vector<naja::DNL::DNLID>& inputs,
+                 const std::vector<naja::DNL::DNLID>& outputs) {
+  naja::DNL::destroy();
+  NLUniverse::get()->setTopDesign(top);
+  builder.setInputs(inputs);
+  builder.setOutputs(outputs);
+  builder.setBuildAIG(true);
+  builder.build();
+}
+
+bool runBench(BenchNetlistGenerator::Kind kind,
+              size_t size,
+              const BenchOptions& options) {
+  PhaseReporter reporter(BenchNetlistGenerator::getKindName(kind), size);
+  NLUniverse* univ = NLUniverse::create();
+  NLDB* db = NLDB::create(univ);
+  BenchNetlistGenerator generator(db);
+  SNLDesign* ref = generator.generate(kind, size, options.seed, 0, "ref");
+  reporter.setInstances(generator.getNumInstances());
+  SNLDesign* impl = generator.generate(kind, size, options.seed, 1, "impl");
+  reporter.report("generate", "impl_instances=" +
+                                  std::to_string(generator.getNumInstances()));
+
+  naja::DNL::destroy();
+  univ->setTopDesign(ref);
+  const size_t numTerms = naja::DNL::get()->getNBterms();
+  reporter.report("dnl", "terms=" + std::to_string(numTerms));
+
+  BuildPrimaryOutputClauses builder0;
+  builder0.collect();
+  std::vector<naja::DNL::DNLID> inputs0 = builder0.getInputs();
+  std::vector<naja::DNL::DNLID> outputs0 = builder0.getOutputs();
+  reporter.report("collect", "inputs=" + std::to_string(inputs0.size()) +
+                                 " outputs=" + std::to_string(outputs0.size()));
+
+  // Per-output phases on the reference design: cloud expansion and its
+  // conversion, then the shared DAG over every output for comparison.
+  std::vector<size_t> varIDs(numTerms, (size_t)-1);
+  for (size_t i = 0; i < inputs0.size(); ++i) {
+    varIDs[inputs0[i]] = i + 2;
+  }
+  const size_t numClouds = std::min(options.cloudOutputs, outputs0.size());
+  if (numClouds > 0) {
+    double computeSeconds = 0;
+    double convertSeconds = 0;
+    AIG cloudAIG;
+    for (size_t i = 0; i < numClouds; ++i) {
+      reporter.lap();
+      SNLLogicCloud cloud(outputs0[i], inputs0, outputs0);
+      cloud.compute();
+      computeSeconds += reporter.lap();
+      Tree2BoolExpr::convert(cloud.getTruthTable(), varIDs, cloudAIG);
+      convertSeconds += reporter.lap();
+      cloud.destroy();
+    }
+    const std::string detail = "outputs=" + std::to_string(numClouds);
+    reporter.report("cloud_compute", computeSeconds, detail);
+    reporter.report("tree_convert", convertSeconds,
+                    detail + " and_nodes=" +
+                        std::to_string(cloudAIG.getNumAnds()));
+  }
+  reporter.lap();
+  {
+    AIG dagAIG;
+    SNLLogicDAG dag(inputs0, outputs0, varIDs, dagAIG);
+    for (auto output : outputs0) {
+      dag.getOutputLit(output);
+    }
+    reporter.report("logic_dag",
+                    "outputs=" + std::to_string(outputs0.size()) +
+                        " and_nodes=" + std::to_string(dagAIG.getNumAnds()));
+  }
+
+  // Miter front half, as MiterStrategy::run does it
+  MiterStrategy miter(ref, impl);
+  naja::DNL::destroy();
+  univ->setTopDesign(impl);
+  BuildPrimaryOutputClauses builder1;
+  builder1.collect();
+  std::vector<naja::DNL::DNLID> inputs1 = builder1.getInputs();
+  std::vector<naja::DNL::DNLID> outputs1 = builder1.getOutputs();
+  miter.normalizeInputs(inputs0, inputs1, builder0.getInputsMap(),
+                        builder1.getInputsMap());
+  miter.normalizeOutputs(outputs0, outputs1, builder0.getOutputsMap(),
+                         builder1.getOutputsMap());
+  reporter.report("normalize");
+
+  buildDesign(ref, builder0, inputs0, outputs0);
+  buildDesign(impl, builder1, inputs1, outputs1);
+  AIG aig = std::move(builder0.getAIG());
+  auto map1 = aig.append(builder1.getAIG());
+  const auto& POs0 = builder0.getPOLits();
+  const auto& POs1 = builder1.getPOLits();
+  std::vector<AIG::Lit> xors;
+  for (size_t i = 0; i < std::min(POs0.size(), POs1.size()); ++i) {
+    xors.push_back(aig.createXor(POs0[i], AIG::remapLit(map1, POs1[i])));
+  }
+  const size_t numClusters = clusterBySupport(aig, xors).size();
+  AIG::Lit miterLit = createBalancedOr(aig, std::move(xors));
+  reporter.report("miter_aig",
+                  "and_nodes=" + std::to_string(aig.getNumAnds()) +
+                      " clusters=" + std::to_string(numClusters));
+
+  Glucose::SimpSolver solver;
+  std::vector<int> node2var;
+  Glucose::Lit rootLit = tseitinEncode(solver, aig, miterLit, node2var);
+  reporter.report("tseitin", "vars=" + std::to_string(solver.nVars()) +
+                                 " clauses=" +
+                                 std::to_string(solver.nClauses()));
+
+  Glucose::vec<Glucose::Lit> assumps;
+  assumps.push(rootLit);
+  const bool sat = solver.solve(assumps);
+  reporter.report("solve", sat ? "SAT" : "UNSAT");
+  // both variants compute the same function
+  bool ok = !sat;
+
+  if (options.runMiter) {
+    reporter.lap();
+    const bool equivalent = miter.run();
+    reporter.report("miter_run", equivalent ? "equivalent" : "different");
+    ok = ok && equivalent;
+  }
+
+  naja::DNL::destroy();
+  NLUniverse::get()->destroy();
+  if (!ok) {
+    std::fprintf(stderr, "kepler_bench: %s/%zu variants were not proven equivalent\n",
+                 BenchNetlistGenerator::getKindName(kind), size);
+  }
+  return ok;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  BenchOptions options;
+  if (!parseOptions(argc, argv, options)) {
+    printUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  Concurrency::configure(options.threads);
+  if (!options.perfReportFile.empty()) {
+    PerfReport::enable();
+  }
+  std::fprintf(stderr, "kepler_bench: %zu threads\n",
+               Concurrency::getNumThreads());
+  std::printf("kind\tsize\tinstances\tphase\tseconds\tdetail\n");
+  bool ok = true;
+  for (auto kind : options.kinds) {
+    for (size_t size : options.sizes) {
+      ok = runBench(kind, size, options) && ok;
+    }
+  }
+  if (!options.perfReportFile.empty() &&
+      !PerfReport::write(options.perfReportFile)) {
+    std::fprintf(stderr, "kepler_bench: could not write %s\n",
+                 options.perfReportFile.c_str());
+    ok = false;
+  }
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
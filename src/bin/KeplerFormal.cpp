@@ -13,7 +13,8 @@
 
 #include <yaml-cpp/yaml.h>
 
-#include "NajaPerf.h"
+#include "Concurrency.h"
+#include "PerfReport.h"
 
 // Naja interfaces
 #include "DNL.h"
@@ -26,8 +27,10 @@
 
 static void print_usage(const char* prog) {
   std::printf(
-      "Usage: %s [--config <file>] | <-naja_if/-verilog> <netlist1> <netlist2> "
-      "[<liberty-file>...]\n",
+      "Usage: %s [--threads <n>] [--numa-node <id>] [--perf-report <file>] "
+      "[--conflict-limit <n>] [--time-limit <s>] [--total-time-limit <s>] "
+      "[--config <file>] | "
+      "<-naja_if/-verilog> <netlist1> <netlist2> [<liberty-file>...]\n",
       prog);
 }
 
@@ -51,6 +54,60 @@ int main(int argc, char** argv) {
   std::vector<std::string> libertyFiles;
   std::string logLevel = "info";
 
+  // Thread budget: --threads / --numa-node are taken out of the arguments
+  // and override the YAML keys; 0 threads uses every core
+  std::optional<size_t> cliThreads;
+  std::optional<int> cliNumaNode;
+  std::string perfReportFile;
+  // Solver limits: the CLI flags override the YAML keys
+  std::optional<int64_t> cliConflictLimit;
+  std::optional<double> cliTimeLimit;
+  std::optional<double> cliTotalTimeLimit;
+  std::vector<char*> args = {argv[0]};
+  for (int i = 1; i < argc; ++i) {
+    const std::string a = argv[i];
+    if (a == "--perf-report" && i + 1 < argc) {
+      perfReportFile = argv[++i];
+      continue;
+    }
+    if ((a == "--threads" || a == "--numa-node") && i + 1 < argc) {
+      try {
+        if (a == "--threads") {
+          cliThreads = std::stoul(argv[++i]);
+        } else {
+          cliNumaNode = std::stoi(argv[++i]);
+        }
+      } catch (const std::exception&) {
+        SPDLOG_CRITICAL("Invalid value for {}: {}", a, argv[i]);
+        return EXIT_FAILURE;
+      }
+      continue;
+    }
+    if ((a == "--conflict-limit" || a == "--time-limit" ||
+         a == "--total-time-limit") &&
+        i + 1 < argc) {
+      try {
+        if (a == "--conflict-limit") {
+          cliConflictLimit = std::stoll(argv[++i]);
+        } else if (a == "--time-limit") {
+          cliTimeLimit = std::stod(argv[++i]);
+        } else {
+          cliTotalTimeLimit = std::stod(argv[++i]);
+        }
+      } catch (const std::exception&) {
+        SPDLOG_CRITICAL("Invalid value for {}: {}", a, argv[i]);
+        return EXIT_FAILURE;
+      }
+      continue;
+    }
+    args.push_back(argv[i]);
+  }
+  argc = static_cast<int>(args.size());
+  args.push_back(nullptr);
+  argv = args.data();
+  size_t threads = 0;
+  int numaNode = -1;
+
   // Basic argument sanity
   if (argc < 2) {
     print_usage(argv[0]);
@@ -61,6 +118,14 @@ int main(int argc, char** argv) {
   bool usedConfig = false;
 
   std::string logFileName;
+  std::string resultCacheFile;
+  std::string counterexampleFile;
+  std::string replayFile;
+  bool satSweeping = true;
+  bool clusteredMiters = true;
+  size_t partitionSupport =
+      KEPLER_FORMAL::MiterStrategy::kDefaultPartitionSupport;
+  KEPLER_FORMAL::SolverLimits solverLimits;
 
   for (int i = 1; i < argc; ++i) {
     std::string a = argv[i];
@@ -102,6 +167,65 @@ int main(int argc, char** argv) {
           logFileName = cfg["log_file"].as<std::string>();
         }
 
+        // Per-output verdicts reused by incremental runs
+        if (cfg["result_cache"] && cfg["result_cache"].IsScalar()) {
+          resultCacheFile = cfg["result_cache"].as<std::string>();
+        }
+
+        // Stimulus written for the differing outputs, and one to replay
+        if (cfg["counterexample_file"] && cfg["counterexample_file"].IsScalar()) {
+          counterexampleFile = cfg["counterexample_file"].as<std::string>();
+        }
+        if (cfg["replay_stimulus"] && cfg["replay_stimulus"].IsScalar()) {
+          replayFile = cfg["replay_stimulus"].as<std::string>();
+        }
+
+        // Internal equivalence merging before the output checks
+        if (cfg["sat_sweeping"] && cfg["sat_sweeping"].IsScalar()) {
+          satSweeping = cfg["sat_sweeping"].as<bool>();
+        }
+
+        // Thread budget of the run and optional NUMA node pinning
+        if (cfg["threads"] && cfg["threads"].IsScalar()) {
+          threads = cfg["threads"].as<size_t>();
+        }
+        if (cfg["numa_node"] && cfg["numa_node"].IsScalar()) {
+          numaNode = cfg["numa_node"].as<int>();
+        }
+
+        // JSON timings of the phases; --perf-report takes precedence
+        if (cfg["perf_report"] && cfg["perf_report"].IsScalar() &&
+            perfReportFile.empty()) {
+          perfReportFile = cfg["perf_report"].as<std::string>();
+        }
+
+        // One solver per output cluster with a disjoint support
+        if (cfg["clustered_miters"] && cfg["clustered_miters"].IsScalar()) {
+          clusteredMiters = cfg["clustered_miters"].as<bool>();
+        }
+        // Largest input support of a cluster before it is split
+        if (cfg["partition_support"] && cfg["partition_support"].IsScalar()) {
+          partitionSupport = cfg["partition_support"].as<size_t>();
+        }
+
+        // Limits of each SAT check and of the whole run (negative counts and
+        // 0 seconds for none), and retries of the undecided outputs
+        if (cfg["conflict_limit"] && cfg["conflict_limit"].IsScalar()) {
+          solverLimits.conflicts = cfg["conflict_limit"].as<int64_t>();
+        }
+        if (cfg["propagation_limit"] && cfg["propagation_limit"].IsScalar()) {
+          solverLimits.propagations = cfg["propagation_limit"].as<int64_t>();
+        }
+        if (cfg["time_limit"] && cfg["time_limit"].IsScalar()) {
+          solverLimits.seconds = cfg["time_limit"].as<double>();
+        }
+        if (cfg["total_time_limit"] && cfg["total_time_limit"].IsScalar()) {
+          solverLimits.totalSeconds = cfg["total_time_limit"].as<double>();
+        }
+        if (cfg["escalations"] && cfg["escalations"].IsScalar()) {
+          solverLimits.escalations = cfg["escalations"].as<unsigned>();
+        }
+
         usedConfig = true;
       } catch (const std::exception& e) {
         SPDLOG_CRITICAL("Failed to parse config {}: {}", cfgPath, e.what());
@@ -161,10 +285,24 @@ int main(int argc, char** argv) {
   else
     spdlog::set_level(spdlog::level::info);
 
+  if (!perfReportFile.empty()) {
+    KEPLER_FORMAL::PerfReport::enable();
+  }
+  if (cliThreads) threads = *cliThreads;
+  if (cliConflictLimit) solverLimits.conflicts = *cliConflictLimit;
+  if (cliTimeLimit) solverLimits.seconds = *cliTimeLimit;
+  if (cliTotalTimeLimit) solverLimits.totalSeconds = *cliTotalTimeLimit;
+  if (cliNumaNode) numaNode = *cliNumaNode;
+  if (!KEPLER_FORMAL::Concurrency::configure(threads, numaNode)) {
+    SPDLOG_WARN("NUMA node {} is not available, threads are not pinned",
+                numaNode);
+  }
+
   std::printf("KEPLER FORMAL: Run.\n");
   std::printf("Input format: %s\n", (inputFormatType == FormatType::SNL) ? "SNL" : "VERILOG");
   std::printf("Netlist 1: %s\n", inputPaths[0].c_str());
   std::printf("Netlist 2: %s\n", inputPaths[1].c_str());
+  std::printf("Threads: %zu\n", KEPLER_FORMAL::Concurrency::getNumThreads());
   if (!libertyFiles.empty()) {
     for (const auto& lf : libertyFiles) std::printf("Liberty: %s\n", lf.c_str());
   }
@@ -174,86 +312,117 @@ int main(int argc, char** argv) {
   // --------------------------------------------------------------------------
   NLUniverse::create();
   NLDB* db0 = nullptr;
+  NLDB* db1 = nullptr;
   bool primitivesAreLoaded = false;
 
-  if (!libertyFiles.empty()) {
+  if (inputFormatType == FormatType::VERILOG) {
+    // Each netlist lives in its own DB with its own primitives library. Naja
+    // is not thread-safe: the Liberty parses create objects in the shared
+    // universe and both Verilog constructions instantiate the process-wide
+    // NLDB0 primitives (assign, gates), so the loads run one after the other.
     db0 = NLDB::create(NLUniverse::get());
-    auto primitivesLibrary =
-        NLLibrary::create(db0, NLLibrary::Type::Primitives, NLName("PRIMS"));
-    SNLLibertyConstructor constructor(primitivesLibrary);
+    db0->setID(2);  // Increment ID to avoid conflicts
+    db1 = NLDB::create(NLUniverse::get());
+    db1->setID(1);
     for (const auto& lf : libertyFiles) {
       std::printf("Loading liberty file: %s\n", lf.c_str());
-      constructor.construct(lf.c_str());
     }
-    primitivesAreLoaded = true;
-  }
-
-  if (inputFormatType == FormatType::VERILOG) {
-    auto designLibrary = NLLibrary::create(db0, NLName("DESIGN"));
-    SNLVRLConstructor constructor(designLibrary);
-    constructor.construct(inputPaths[0].c_str());
-    auto top = SNLUtils::findTop(designLibrary);
-    if (top) {
-      db0->setTopDesign(top);
-      SPDLOG_INFO("Found top design: {}", top->getString());
-    } else {
+    auto loadLiberty = [&](NLDB* db, size_t design) {
+      KEPLER_FORMAL::PerfReport::Phase phase("liberty_load");
+      auto primitivesLibrary =
+          NLLibrary::create(db, NLLibrary::Type::Primitives, NLName("PRIMS"));
+      SNLLibertyConstructor constructor(primitivesLibrary);
+      for (const auto& lf : libertyFiles) {
+        constructor.construct(lf.c_str());
+      }
+      phase.add("design", design).add("files", libertyFiles.size());
+    };
+    auto loadVerilog = [&](NLDB* db, size_t design) {
+      const std::string& path = inputPaths[design];
+      KEPLER_FORMAL::PerfReport::Phase phase("netlist_load");
+      phase.add("design", design);
+      auto designLibrary = NLLibrary::create(db, NLName("DESIGN"));
+      SNLVRLConstructor constructor(designLibrary);
+      constructor.construct(path.c_str());
+      auto top = SNLUtils::findTop(designLibrary);
+      if (top) {
+        db->setTopDesign(top);
+        SPDLOG_INFO("Found top design: {}", top->getString());
+      }
+    };
+    try {
+      if (!libertyFiles.empty()) {
+        loadLiberty(db0, 0);
+      }
+      loadVerilog(db0, 0);
+      if (!libertyFiles.empty()) {
+        loadLiberty(db1, 1);
+      }
+      loadVerilog(db1, 1);
+    } catch (const std::exception& e) {
+      // LCOV_EXCL_START
+      SPDLOG_CRITICAL("Failed to load netlists: {}", e.what());
+      return EXIT_FAILURE;
+      // LCOV_EXCL_STOP
+    }
+    if (!db0->getTopDesign() || !db1->getTopDesign()) {
       // LCOV_EXCL_START
       SPDLOG_CRITICAL("No top design was found after parsing verilog");
       return EXIT_FAILURE;
       // LCOV_EXCL_STOP
     }
   } else {  // SNL
+    // Naja IF dumps reference their primitives by DB ID, so the loads stay
+    // sequential with the primitives DB recreated in between.
+    if (!libertyFiles.empty()) {
+      KEPLER_FORMAL::PerfReport::Phase phase("liberty_load");
+      phase.add("design", 0).add("files", libertyFiles.size());
+      db0 = NLDB::create(NLUniverse::get());
+      auto primitivesLibrary =
+          NLLibrary::create(db0, NLLibrary::Type::Primitives, NLName("PRIMS"));
+      SNLLibertyConstructor constructor(primitivesLibrary);
+      for (const auto& lf : libertyFiles) {
+        std::printf("Loading liberty file: %s\n", lf.c_str());
+        constructor.construct(lf.c_str());
+      }
+      primitivesAreLoaded = true;
+    }
     std::printf("Loading SNL file: %s\n", inputPaths[0].c_str());
+    KEPLER_FORMAL::PerfReport::Phase load0Phase("netlist_load");
+    load0Phase.add("design", 0);
     db0 = SNLCapnP::load(inputPaths[0].c_str(), primitivesAreLoaded);
+    load0Phase.stop();
     if (!db0) {
       // LCOV_EXCL_START
       SPDLOG_CRITICAL("Failed to load SNL file: {}", inputPaths[0]);
       return EXIT_FAILURE;
       // LCOV_EXCL_STOP
     }
-  }
-
-  // get db0 top
-  auto top0 = db0->getTopDesign();
-  if (!top0) {
-    // LCOV_EXCL_START
-    SPDLOG_CRITICAL("Top design not set for first netlist");
-    return EXIT_FAILURE;
-    // LCOV_EXCL_STOP
-  }
-  db0->setID(2);  // Increment ID to avoid conflicts
-
-  NLDB* db1 = nullptr;
-
-  // Prepare second DB and primitives if needed
-  if (!libertyFiles.empty()) {
-    db1 = NLDB::create(NLUniverse::get());
-    db1->setID(1);
-    auto primitivesLibrary =
-        NLLibrary::create(db1, NLLibrary::Type::Primitives, NLName("PRIMS"));
-    SNLLibertyConstructor constructor(primitivesLibrary);
-    for (const auto& lf : libertyFiles) {
-      constructor.construct(lf.c_str());
-    }
-  }
-
-  if (inputFormatType == FormatType::VERILOG) {
-    auto designLibrary = NLLibrary::create(db1, NLName("DESIGN"));
-    SNLVRLConstructor constructor(designLibrary);
-    constructor.construct(inputPaths[1].c_str());
-    auto top = SNLUtils::findTop(designLibrary);
-    if (top) {
-      db1->setTopDesign(top);
-      SPDLOG_INFO("Found top design: {}", top->getString());
-    } else {
+    if (!db0->getTopDesign()) {
       // LCOV_EXCL_START
-      SPDLOG_CRITICAL("No top design was found after parsing verilog");
+      SPDLOG_CRITICAL("Top design not set for first netlist");
       return EXIT_FAILURE;
       // LCOV_EXCL_STOP
     }
-  } else {  // SNL
+    db0->setID(2);  // Increment ID to avoid conflicts
+
+    if (!libertyFiles.empty()) {
+      KEPLER_FORMAL::PerfReport::Phase phase("liberty_load");
+      phase.add("design", 1).add("files", libertyFiles.size());
+      db1 = NLDB::create(NLUniverse::get());
+      db1->setID(1);
+      auto primitivesLibrary =
+          NLLibrary::create(db1, NLLibrary::Type::Primitives, NLName("PRIMS"));
+      SNLLibertyConstructor constructor(primitivesLibrary);
+      for (const auto& lf : libertyFiles) {
+        constructor.construct(lf.c_str());
+      }
+    }
     std::printf("Loading SNL file: %s\n", inputPaths[1].c_str());
+    KEPLER_FORMAL::PerfReport::Phase load1Phase("netlist_load");
+    load1Phase.add("design", 1);
     db1 = SNLCapnP::load(inputPaths[1].c_str(), primitivesAreLoaded);
+    load1Phase.stop();
     if (!db1) {
       // LCOV_EXCL_START
       SPDLOG_CRITICAL("Failed to load SNL file: {}", inputPaths[1]);
@@ -262,6 +431,15 @@ int main(int argc, char** argv) {
     }
   }
 
+  // get db0 top
+  auto top0 = db0->getTopDesign();
+  if (!top0) {
+    // LCOV_EXCL_START
+    SPDLOG_CRITICAL("Top design not set for first netlist");
+    return EXIT_FAILURE;
+    // LCOV_EXCL_STOP
+  }
+
   // get db1 top
   auto top1 = db1->getTopDesign();
   if (!top1) {
@@ -276,8 +454,20 @@ int main(int argc, char** argv) {
   // --------------------------------------------------------------------------
   try {
     KEPLER_FORMAL::MiterStrategy MiterS(top0, top1, logFileName);
+    MiterS.setResultCacheFile(resultCacheFile);
+    MiterS.setCounterexampleFile(counterexampleFile);
+    MiterS.setReplayFile(replayFile);
+    MiterS.setSATSweeping(satSweeping);
+    MiterS.setClusteredMiters(clusteredMiters);
+    MiterS.setPartitionSupport(partitionSupport);
+    MiterS.setSolverLimits(solverLimits);
     if (MiterS.run()) {
       SPDLOG_INFO("No difference was found.");
+    } else if (MiterS.getNumDifferent() == 0) {
+      SPDLOG_WARN("No difference was found, but {} outputs are undecided "
+                  "within the solver limits. Please refer to the "
+                  "log(miter_log_x.txt) for the list.",
+                  MiterS.getNumUndecided());
     } else {
       SPDLOG_INFO("Difference was found. Please refer to the log(miter_log_x.txt) for details.");
     }
@@ -288,5 +478,13 @@ int main(int argc, char** argv) {
     // LCOV_EXCL_STOP
   }
 
+  if (!perfReportFile.empty()) {
+    if (KEPLER_FORMAL::PerfReport::write(perfReportFile)) {
+      SPDLOG_INFO("Wrote performance report to {}", perfReportFile);
+    } else {
+      SPDLOG_WARN("Could not write performance report {}", perfReportFile);
+    }
+  }
+
   return EXIT_SUCCESS;
 }
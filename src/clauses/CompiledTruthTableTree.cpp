@@ -0,0 +1,230 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "CompiledTruthTableTree.h"
+#include <tbb/enumerable_thread_specific.h>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+using namespace KEPLER_FORMAL;
+
+namespace {
+
+using Node = SNLTruthTableTree::Node;
+
+// While compiling, operands refer to instruction results by index since the
+// number of input slots is only known at the end
+constexpr uint32_t kResultBit = 0x80000000u;
+constexpr uint32_t kUnset = 0xffffffffu;
+
+// per-thread slot and cofactor words of evaluate()
+tbb::enumerable_thread_specific<std::vector<uint64_t>> slotsETS;
+tbb::enumerable_thread_specific<std::vector<uint64_t>> foldETS;
+
+}  // namespace
+
+CompiledTruthTableTree::CompiledTruthTableTree(const SNLTruthTableTree& tree) {
+  const auto& root = tree.getRoot();
+  if (!root) {
+    // LCOV_EXCL_START
+    throw std::logic_error("CompiledTruthTableTree: tree has no root");
+    // LCOV_EXCL_STOP
+  }
+  compile(*root, nullptr);
+}
+
+CompiledTruthTableTree::CompiledTruthTableTree(const Node& root) {
+  compile(root, nullptr);
+}
+
+CompiledTruthTableTree::CompiledTruthTableTree(
+    const SNLTruthTableTree& tree,
+    const std::vector<size_t>& varIDs) {
+  const auto& root = tree.getRoot();
+  if (!root) {
+    // LCOV_EXCL_START
+    throw std::logic_error("CompiledTruthTableTree: tree has no root");
+    // LCOV_EXCL_STOP
+  }
+  compile(*root, &varIDs);
+}
+
+void CompiledTruthTableTree::compile(const Node& root,
+                                     const std::vector<size_t>* varIDs) {
+  const SNLTruthTableTree& tree = *root.tree;
+  // operand of each visited node: 0/1 constants, input row + 2 or result
+  std::vector<uint32_t> refs(tree.getMaxID() + 1, kUnset);
+
+  using Frame = std::pair<const Node*, bool>;
+  std::vector<Frame> stack;
+  stack.emplace_back(&root, false);
+
+  while (!stack.empty()) {
+    const auto [node, postVisit] = stack.back();
+    stack.pop_back();
+    const uint32_t id = node->nodeID;
+
+    if (!postVisit) {
+      if (refs[id] != kUnset) continue;
+      if (node->type != Node::Type::Input) {
+        stack.emplace_back(node, true);
+        for (uint32_t c : node->childrenIds) {
+          const auto& child = tree.nodeFromId(c);
+          if (!child) {
+            // LCOV_EXCL_START
+            throw std::logic_error("CompiledTruthTableTree: null child node");
+            // LCOV_EXCL_STOP
+          }
+          stack.emplace_back(child.get(), false);
+        }
+        continue;
+      }
+      size_t row = node->data.inputIndex;
+      if (varIDs != nullptr) {
+        if (node->parentIds.empty()) {
+          // LCOV_EXCL_START
+          throw std::runtime_error("Input node has no parent");
+          // LCOV_EXCL_STOP
+        }
+        const auto& parent = tree.nodeFromId(node->parentIds[0]);
+        const size_t varID = (*varIDs)[parent->data.termid];
+        if (varID == (size_t)-1) {
+          // LCOV_EXCL_START
+          throw std::runtime_error("Input variable index is SIZE_MAX");
+          // LCOV_EXCL_STOP
+        }
+        if (varID < 2) {
+          refs[id] = static_cast<uint32_t>(varID);
+          continue;
+        }
+        row = varID - 2;
+      }
+      numInputs_ = std::max(numInputs_, row + 1);
+      refs[id] = static_cast<uint32_t>(row + 2);
+      continue;
+    }
+
+    const CellFunction& function = node->getFunction();
+    const uint32_t arity = function.numInputs;
+    if (node->childrenIds.size() != arity) {
+      // LCOV_EXCL_START
+      throw std::logic_error("TableNode: children count mismatch");
+      // LCOV_EXCL_STOP
+    }
+    if (node->type == Node::Type::P) {
+      refs[id] = refs[tree.nodeFromId(node->childrenIds[0])->nodeID];
+      continue;
+    }
+    if (function.isConstant) {
+      refs[id] = function.constantValue ? 1 : 0;
+      continue;
+    }
+    Instruction instruction;
+    instruction.arity = arity;
+    instruction.firstOperand = static_cast<uint32_t>(operands_.size());
+    instruction.firstTableWord = static_cast<uint32_t>(tableWords_.size());
+    for (uint32_t c : node->childrenIds) {
+      operands_.push_back(refs[tree.nodeFromId(c)->nodeID]);
+    }
+    tableWords_.insert(tableWords_.end(), function.words.begin(),
+                       function.words.end());
+    const uint64_t rows = uint64_t{1} << arity;
+    if (arity <= kMaxFoldArity) {
+      foldRows_ = std::max<size_t>(foldRows_, rows);
+    }
+    refs[id] = kResultBit | static_cast<uint32_t>(instructions_.size());
+    instructions_.push_back(instruction);
+  }
+
+  const uint32_t firstResult = static_cast<uint32_t>(numInputs_ + 2);
+  auto toSlot = [&](uint32_t ref) {
+    return (ref & kResultBit) ? firstResult + (ref & ~kResultBit) : ref;
+  };
+  for (uint32_t& operand : operands_) {
+    operand = toSlot(operand);
+  }
+  for (size_t i = 0; i < instructions_.size(); ++i) {
+    instructions_[i].output = firstResult + static_cast<uint32_t>(i);
+  }
+  numSlots_ = firstResult + static_cast<uint32_t>(instructions_.size());
+  rootSlot_ = toSlot(refs[root.nodeID]);
+}
+
+void CompiledTruthTableTree::evaluate(const uint64_t* inputs,
+                                      size_t numWords,
+                                      uint64_t* out) const {
+  constexpr size_t B = kBlockWords;
+  auto& slots = slotsETS.local();
+  auto& fold = foldETS.local();
+  slots.resize(size_t{numSlots_} * B);
+  fold.resize(foldRows_ * B);
+  std::fill_n(slots.data(), B, 0);
+  std::fill_n(slots.data() + B, B, ~uint64_t{0});
+
+  for (size_t begin = 0; begin < numWords; begin += B) {
+    const size_t n = std::min(B, numWords - begin);
+    for (size_t i = 0; i < numInputs_; ++i) {
+      uint64_t* slot = slots.data() + (i + 2) * B;
+      std::copy_n(inputs + i * numWords + begin, n, slot);
+      std::fill(slot + n, slot + B, 0);
+    }
+
+    for (const Instruction& instruction : instructions_) {
+      const uint32_t* operands = operands_.data() + instruction.firstOperand;
+      const uint64_t* table = tableWords_.data() + instruction.firstTableWord;
+      uint64_t* result = slots.data() + size_t{instruction.output} * B;
+      if (instruction.arity > kMaxFoldArity) {
+        for (size_t w = 0; w < B; ++w) {
+          uint64_t word = 0;
+          for (size_t b = 0; b < 64; ++b) {
+            uint64_t m = 0;
+            for (uint32_t j = 0; j < instruction.arity; ++j) {
+              m |= ((slots[operands[j] * B + w] >> b) & 1) << j;
+            }
+            word |= ((table[m >> 6] >> (m & 63)) & 1) << b;
+          }
+          result[w] = word;
+        }
+        continue;
+      }
+      // Shannon fold: cofactor m of the table is a constant word, each input
+      // j then muxes the cofactor pairs that differ in bit j
+      const size_t rows = size_t{1} << instruction.arity;
+      for (size_t m = 0; m < rows; ++m) {
+        const uint64_t value =
+            ((table[m >> 6] >> (m & 63)) & 1) ? ~uint64_t{0} : 0;
+        std::fill_n(fold.data() + m * B, B, value);
+      }
+      for (uint32_t j = 0; j < instruction.arity; ++j) {
+        const uint64_t* x = slots.data() + size_t{operands[j]} * B;
+        const size_t half = rows >> (j + 1);
+        for (size_t m = 0; m < half; ++m) {
+          const uint64_t* lo = fold.data() + 2 * m * B;
+          const uint64_t* hi = lo + B;
+          uint64_t mux[B];
+          for (size_t w = 0; w < B; ++w) {
+            mux[w] = (x[w] & hi[w]) | (~x[w] & lo[w]);
+          }
+          std::copy_n(mux, B, fold.data() + m * B);
+        }
+      }
+      std::copy_n(fold.data(), B, result);
+    }
+
+    std::copy_n(slots.data() + size_t{rootSlot_} * B, n, out + begin);
+  }
+}
+
+bool CompiledTruthTableTree::eval(const std::vector<bool>& inputs) const {
+  if (inputs.size() < numInputs_) {
+    throw std::out_of_range("Input index out of range");
+  }
+  std::vector<uint64_t> words(numInputs_);
+  for (size_t i = 0; i < numInputs_; ++i) {
+    words[i] = inputs[i] ? ~uint64_t{0} : 0;
+  }
+  uint64_t out = 0;
+  evaluate(words.data(), 1, &out);
+  return out & 1;
+}
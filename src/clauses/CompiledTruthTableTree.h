@@ -0,0 +1,72 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "SNLTruthTableTree.h"
+
+namespace KEPLER_FORMAL {
+
+/// Bit-parallel evaluator of a truth-table tree.
+///
+/// The tree is flattened once into a topologically ordered instruction array,
+/// one instruction per Table node with shared children evaluated once; P nodes
+/// are pass-throughs and cost nothing. Each pass over the instructions then
+/// evaluates kBlockWords * 64 patterns: a k-input table is applied by muxing
+/// its 2^k cofactor words with its inputs, plain word loops the compiler
+/// vectorizes, instead of one bit lookup per pattern.
+///
+/// Slot 0 and 1 hold the constants and input row i feeds slot i + 2, so in
+/// var-id mode input row i is var id i + 2, as for the AIG inputs.
+class CompiledTruthTableTree {
+ public:
+  // Input row i is external input i, as for SNLTruthTableTree::eval()
+  explicit CompiledTruthTableTree(const SNLTruthTableTree& tree);
+  // Sub-tree under `root`, resolved through root.tree
+  explicit CompiledTruthTableTree(const SNLTruthTableTree::Node& root);
+  // Input nodes read the var id of the terminal of their P parent, as in
+  // Tree2BoolExpr::convert(); var ids 0 and 1 are the constants
+  CompiledTruthTableTree(const SNLTruthTableTree& tree,
+                         const std::vector<size_t>& varIDs);
+
+  // Number of input rows evaluate() reads
+  size_t getNumInputs() const { return numInputs_; }
+  size_t getNumInstructions() const { return instructions_.size(); }
+
+  // inputs holds getNumInputs() rows of numWords words, out numWords words;
+  // bit b of word w is pattern 64 * w + b.
+  void evaluate(const uint64_t* inputs, size_t numWords, uint64_t* out) const;
+
+  // Single pattern
+  bool eval(const std::vector<bool>& inputs) const;
+
+  // Words evaluated per pass over the instructions (512 patterns)
+  static constexpr size_t kBlockWords = 8;
+  // Widest table applied by cofactor muxing; wider ones are looked up per
+  // pattern
+  static constexpr uint32_t kMaxFoldArity = 8;
+
+ private:
+  struct Instruction {
+    uint32_t arity;
+    uint32_t firstOperand;   // into operands_
+    uint32_t firstTableWord; // into tableWords_
+    uint32_t output;         // slot
+  };
+
+  void compile(const SNLTruthTableTree::Node& root,
+               const std::vector<size_t>* varIDs);
+
+  std::vector<Instruction> instructions_;
+  std::vector<uint32_t> operands_;
+  std::vector<uint64_t> tableWords_;  // truth-table bits, minterm-major
+  size_t numInputs_ = 0;
+  uint32_t numSlots_ = 2;
+  uint32_t rootSlot_ = 0;
+  size_t foldRows_ = 1;  // cofactor words of the widest folded table
+};
+
+}  // namespace KEPLER_FORMAL
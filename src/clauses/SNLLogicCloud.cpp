@@ -5,7 +5,6 @@
 #include <tbb/tbb_allocator.h>
 #include <cassert>
 #include "SNLDesignModeling.h"
-#include "tbb/concurrent_vector.h"
 #include "tbb/enumerable_thread_specific.h"
 
 typedef std::pair<
@@ -16,52 +15,12 @@ tbb::enumerable_thread_specific<IterationInputsETSPair>
     currentIterationInputsETS;
 tbb::enumerable_thread_specific<IterationInputsETSPair> newIterationInputsETS;
 
-tbb::concurrent_vector<IterationInputsETSPair*>
-    currentIterationInputsETSvector =
-        tbb::concurrent_vector<IterationInputsETSPair*>(40, nullptr);
-
-tbb::concurrent_vector<IterationInputsETSPair*> newIterationInputsETSvector =
-    tbb::concurrent_vector<IterationInputsETSPair*>(40, nullptr);
-
-void initCurrentIterationInputsETS() {
-  // LCOV_EXCL_START
-  if (currentIterationInputsETSvector.size() <= tbb::this_task_arena::current_thread_index()) {
-    for (size_t i = currentIterationInputsETSvector.size(); i <= tbb::this_task_arena::current_thread_index(); i++) {
-      currentIterationInputsETSvector.push_back(nullptr);
-    }
-  }
-  // LCOV_EXCL_STOP
-  if (currentIterationInputsETSvector
-          [tbb::this_task_arena::current_thread_index()] == nullptr) {
-    currentIterationInputsETSvector
-        [tbb::this_task_arena::current_thread_index()] =
-            &currentIterationInputsETS.local();
-  }
-}
-
 IterationInputsETSPair& getCurrentIterationInputsETS() {
-  return *currentIterationInputsETSvector
-      [tbb::this_task_arena::current_thread_index()];
-}
-
-void initNewIterationInputsETS() {
-  // LCOV_EXCL_START
-  if (newIterationInputsETSvector.size() <= tbb::this_task_arena::current_thread_index()) {
-    for (size_t i = newIterationInputsETSvector.size(); i <= tbb::this_task_arena::current_thread_index(); i++) {
-      newIterationInputsETSvector.push_back(nullptr);
-    }
-  }
-  // LCOV_EXCL_STOP
-  if (newIterationInputsETSvector
-          [tbb::this_task_arena::current_thread_index()] == nullptr) {
-    newIterationInputsETSvector[tbb::this_task_arena::current_thread_index()] =
-        &newIterationInputsETS.local();
-  }
+  return currentIterationInputsETS.local();
 }
 
 IterationInputsETSPair& getNewIterationInputsETS() {
-  return *newIterationInputsETSvector
-      [tbb::this_task_arena::current_thread_index()];
+  return newIterationInputsETS.local();
 }
 
 void clearCurrentIterationInputsETS() {
@@ -151,8 +110,6 @@ bool SNLLogicCloud::isOutput(naja::DNL::DNLID termID) {
 void SNLLogicCloud::compute() {
   // std::vector<naja::DNL::DNLID, tbb::tbb_allocator<naja::DNL::DNLID>>
   // newIterationInputs;
-  initNewIterationInputsETS();
-  initCurrentIterationInputsETS();
   clearNewIterationInputsETS();
   clearCurrentIterationInputsETS();
   DEBUG_LOG("---- Begin!!\n");
@@ -0,0 +1,251 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "SNLLogicDAG.h"
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include "SNLDesignModeling.h"
+#include "SNLTruthTablePool.h"
+
+using namespace KEPLER_FORMAL;
+using namespace naja::DNL;
+using namespace naja::NL;
+
+namespace {
+
+uint64_t mix(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+uint64_t hashCombine(uint64_t seed, uint64_t value) {
+  return mix(seed ^ mix(value));
+}
+
+}  // namespace
+
+size_t SNLLogicDAG::CellKeyHash::operator()(const CellKey& key) const {
+  uint64_t hash = mix(reinterpret_cast<uintptr_t>(key.first));
+  for (AIG::Lit lit : key.second) {
+    hash = hashCombine(hash, lit);
+  }
+  return static_cast<size_t>(hash);
+}
+
+SNLLogicDAG::SNLLogicDAG(const std::vector<DNLID>& PIs,
+                         const std::vector<DNLID>& POs,
+                         const std::vector<size_t>& varIDs,
+                         AIG& aig)
+    : SNLLogicDAG(*naja::DNL::get(), PIs, POs, varIDs, aig) {}
+
+SNLLogicDAG::SNLLogicDAG(const DNLFull& dnl,
+                         const std::vector<DNLID>& PIs,
+                         const std::vector<DNLID>& POs,
+                         const std::vector<size_t>& varIDs,
+                         AIG& aig)
+    : dnl_(dnl), varIDs_(varIDs), aig_(aig) {
+  const size_t numTerms = dnl_.getNBterms();
+  PIs_ = std::vector<bool>(numTerms, false);
+  for (auto pi : PIs) {
+    PIs_[pi] = true;
+  }
+  POs_ = std::vector<bool>(numTerms, false);
+  for (auto po : POs) {
+    POs_[po] = true;
+  }
+  // every iso holds at least one term
+  isoLits_.assign(numTerms, AIG::kNoLit);
+  isoHashes_.assign(numTerms, 0);
+  onPath_.assign(numTerms, false);
+  // DNLTerminalFull::getDNLInstance() and isTopPort() resolve through the
+  // current DNL, so instances are indexed here from the leaves of dnl_
+  topTerms_ = dnl_.getTop().getTermIndexes();
+  termInstances_.assign(numTerms, DNLID_MAX);
+  for (DNLID leaf : dnl_.getLeaves()) {
+    const auto terms = dnl_.getDNLInstanceFromID(leaf).getTermIndexes();
+    for (DNLID termID = terms.first;
+         termID != DNLID_MAX && termID <= terms.second; termID++) {
+      termInstances_[termID] = leaf;
+    }
+  }
+}
+
+DNLInstanceFull SNLLogicDAG::getInstance(DNLID termID) const {
+  if (termInstances_[termID] == DNLID_MAX) {
+    // LCOV_EXCL_START
+    throw std::runtime_error(
+        "Driver '" +
+        dnl_.getDNLTerminalFromID(termID).getSnlBitTerm()->getName().getString() +
+        "' is not a leaf instance term");
+    // LCOV_EXCL_STOP
+  }
+  return dnl_.getDNLInstanceFromID(termInstances_[termID]);
+}
+
+AIG::Lit SNLLogicDAG::getVarLit(DNLID termID) const {
+  if (termID >= varIDs_.size() || varIDs_[termID] == (size_t)-1) {
+    // LCOV_EXCL_START
+    throw std::runtime_error("Input variable index is SIZE_MAX");
+    // LCOV_EXCL_STOP
+  }
+  // var ids 0 and 1 are folded to the AIG constants
+  return aig_.createInput(varIDs_[termID]);
+}
+
+uint64_t SNLLogicDAG::getVarHash(DNLID termID) const {
+  // constant inputs hash by value, whatever term they come from
+  if (varIDs_[termID] < 2 || inputHashes_ == nullptr) {
+    return mix(varIDs_[termID]);
+  }
+  return (*inputHashes_)[termID];
+}
+
+DNLID SNLLogicDAG::getDriver(DNLID isoID) const {
+  const auto& iso = dnl_.getDNLIsoDB().getIsoFromIsoIDconst(isoID);
+  if (iso.getDrivers().size() != 1) {
+    // LCOV_EXCL_START
+    std::string termName = "<no reader>";
+    if (!iso.getReaders().empty()) {
+      termName = dnl_.getDNLTerminalFromID(iso.getReaders().front())
+                     .getSnlBitTerm()
+                     ->getName()
+                     .getString();
+    }
+    throw std::runtime_error(
+        "Iso read by '" + termName + "' has " +
+        std::to_string(iso.getDrivers().size()) +
+        " drivers, exactly one is supported");
+    // LCOV_EXCL_STOP
+  }
+  return iso.getDrivers().front();
+}
+
+AIG::Lit SNLLogicDAG::getOutputLit(DNLID seedOutputTerm, uint64_t* coneHash) {
+  const DNLTerminalFull& seed = dnl_.getDNLTerminalFromID(seedOutputTerm);
+  if (isTopTerm(seedOutputTerm) || isOutput(seedOutputTerm)) {
+    AIG::Lit lit = getIsoLit(seed.getIsoID());
+    if (coneHash) *coneHash = isoHashes_[seed.getIsoID()];
+    return lit;
+  }
+  // a driver term asked directly: expand its own table
+  auto [lit, hash] = buildDriver(seedOutputTerm);
+  if (coneHash) *coneHash = hash;
+  return lit;
+}
+
+std::pair<AIG::Lit, uint64_t> SNLLogicDAG::getTermLit(DNLID termID) {
+  if (isInput(termID)) {
+    return {getVarLit(termID), getVarHash(termID)};
+  }
+  DNLID isoID = dnl_.getDNLTerminalFromID(termID).getIsoID();
+  AIG::Lit lit = getIsoLit(isoID);
+  return {lit, isoHashes_[isoID]};
+}
+
+AIG::Lit SNLLogicDAG::getIsoLit(DNLID isoID) {
+  if (isoLits_[isoID] != AIG::kNoLit) {
+    return isoLits_[isoID];
+  }
+  // Post-order walk over isos; a pending entry always sits below the expanded
+  // entry of the same iso, so meeting an iso still on the path is a loop.
+  std::vector<std::pair<DNLID, bool>> stack;
+  stack.emplace_back(isoID, false);
+  while (!stack.empty()) {
+    auto [iso, expanded] = stack.back();
+    stack.pop_back();
+    if (isoLits_[iso] != AIG::kNoLit) continue;
+    DNLID driver = getDriver(iso);
+    if (isInput(driver)) {
+      isoLits_[iso] = getVarLit(driver);
+      isoHashes_[iso] = getVarHash(driver);
+      continue;
+    }
+    if (expanded) {
+      std::tie(isoLits_[iso], isoHashes_[iso]) = buildDriver(driver);
+      onPath_[iso] = false;
+      continue;
+    }
+    if (onPath_[iso]) {
+      // LCOV_EXCL_START
+      throw std::runtime_error(
+          "Combinational loop through '" +
+          dnl_.getDNLTerminalFromID(driver).getSnlBitTerm()->getName().getString() +
+          "'");
+      // LCOV_EXCL_STOP
+    }
+    onPath_[iso] = true;
+    stack.emplace_back(iso, true);
+    auto inst = getInstance(driver);
+    for (DNLID termID = inst.getTermIndexes().first;
+         termID <= inst.getTermIndexes().second; termID++) {
+      const DNLTerminalFull& term = dnl_.getDNLTerminalFromID(termID);
+      if (term.getSnlBitTerm()->getDirection() ==
+              SNLBitTerm::Direction::Output ||
+          isInput(termID)) {
+        continue;
+      }
+      if (isoLits_[term.getIsoID()] == AIG::kNoLit) {
+        stack.emplace_back(term.getIsoID(), false);
+      }
+    }
+  }
+  return isoLits_[isoID];
+}
+
+std::pair<const CellFunction*, uint64_t> SNLLogicDAG::getCellFunction(
+    DNLID driver) {
+  const DNLTerminalFull& driverTerm = dnl_.getDNLTerminalFromID(driver);
+  const SNLDesign* model = getInstance(driver).getSNLModel();
+  const uint32_t orderID = driverTerm.getSnlBitTerm()->getOrderID();
+  auto it = cellFunctions_.find({model, orderID});
+  if (it != cellFunctions_.end()) {
+    return it->second;
+  }
+  const uint32_t index = SNLTruthTablePool::intern(
+      SNLDesignModeling::getTruthTable(model, orderID));
+  if (index == SNLTruthTablePool::kNoTable) {
+    // LCOV_EXCL_START
+    throw std::logic_error("SNLLogicDAG: uninitialized truth table for '" +
+                           driverTerm.getSnlBitTerm()->getName().getString() +
+                           "'");
+    // LCOV_EXCL_STOP
+  }
+  const CellFunction& function = SNLTruthTablePool::getFunction(index);
+  uint64_t hash = mix(function.numInputs);
+  for (uint64_t word : function.words) {
+    hash = hashCombine(hash, word);
+  }
+  return cellFunctions_[{model, orderID}] = {&function, hash};
+}
+
+std::pair<AIG::Lit, uint64_t> SNLLogicDAG::buildDriver(DNLID driver) {
+  auto inst = getInstance(driver);
+  auto [function, hash] = getCellFunction(driver);
+  // Table input j is the j-th non-output term of the instance, as in the
+  // truth-table tree. Under getIsoLit the children are already resolved and
+  // this only reads the memo.
+  std::vector<AIG::Lit> childLits;
+  for (DNLID termID = inst.getTermIndexes().first;
+       termID <= inst.getTermIndexes().second; termID++) {
+    const DNLTerminalFull& term = dnl_.getDNLTerminalFromID(termID);
+    if (term.getSnlBitTerm()->getDirection() != SNLBitTerm::Direction::Output) {
+      auto [lit, childHash] = getTermLit(termID);
+      childLits.push_back(lit);
+      hash = hashCombine(hash, childHash);
+    }
+  }
+  auto [it, inserted] =
+      cellLits_.try_emplace({function, std::move(childLits)}, AIG::kNoLit);
+  if (!inserted) {
+    ++numStrashedDrivers_;
+    return {it->second, hash};
+  }
+  ++numExpandedDrivers_;
+  it->second = function->instantiate(it->first.second.data(), aig_);
+  return {it->second, hash};
+}
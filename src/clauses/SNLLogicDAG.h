@@ -0,0 +1,104 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "AIG.h"
+#include "CellFunction.h"
+#include "DNL.h"
+
+namespace KEPLER_FORMAL {
+
+/// Netlist-wide logic DAG: the function of every iso reached from the
+/// requested outputs is built once into a shared AIG and memoized by iso ID,
+/// so overlapping fan-in cones are walked and converted a single time.
+///
+/// Inputs follow SNLLogicCloud: a term in PIs (or an iso driven by one) is a
+/// variable, any other driver is expanded through its cell truth table.
+///
+/// Cells are strashed: a driver whose cell function and input literals match
+/// an already expanded one reuses its literal instead of being expanded
+/// again, so duplicated logic costs one expansion. Across designs the same
+/// holds at AIG level once their AIGs are appended into one.
+///
+/// Along with the literal, every iso gets a structural hash of its cone
+/// (cell tables, pin order and input hashes, no instance names), stable
+/// across runs so verdicts can be reused when a cone is untouched.
+class SNLLogicDAG {
+ public:
+  SNLLogicDAG(const std::vector<naja::DNL::DNLID>& PIs,
+              const std::vector<naja::DNL::DNLID>& POs,
+              const std::vector<size_t>& varIDs,
+              AIG& aig);
+  /// On a given DNL, which need not be the current one: only its own tables
+  /// are read, so DAGs of two designs can be built at the same time
+  SNLLogicDAG(const naja::DNL::DNLFull& dnl,
+              const std::vector<naja::DNL::DNLID>& PIs,
+              const std::vector<naja::DNL::DNLID>& POs,
+              const std::vector<size_t>& varIDs,
+              AIG& aig);
+
+  /// Hash of each input term, indexed by DNLID; inputs default to a hash of
+  /// their var id
+  void setInputHashes(const std::vector<uint64_t>& inputHashes) {
+    inputHashes_ = &inputHashes;
+  }
+
+  /// Literal of the function seen at seedOutputTerm (same seed semantics as
+  /// SNLLogicCloud::compute); coneHash, when given, receives its cone hash
+  AIG::Lit getOutputLit(naja::DNL::DNLID seedOutputTerm,
+                        uint64_t* coneHash = nullptr);
+
+  size_t getNumExpandedDrivers() const { return numExpandedDrivers_; }
+  // Drivers that reused the literal of an identical cell
+  size_t getNumStrashedDrivers() const { return numStrashedDrivers_; }
+
+ private:
+  bool isInput(naja::DNL::DNLID termID) const { return PIs_[termID]; }
+  bool isOutput(naja::DNL::DNLID termID) const { return POs_[termID]; }
+  bool isTopTerm(naja::DNL::DNLID termID) const {
+    return termID >= topTerms_.first && termID <= topTerms_.second;
+  }
+  // Leaf instance of a term, looked up in dnl_ rather than the current DNL
+  naja::DNL::DNLInstanceFull getInstance(naja::DNL::DNLID termID) const;
+  AIG::Lit getVarLit(naja::DNL::DNLID termID) const;
+  uint64_t getVarHash(naja::DNL::DNLID termID) const;
+  naja::DNL::DNLID getDriver(naja::DNL::DNLID isoID) const;
+  AIG::Lit getIsoLit(naja::DNL::DNLID isoID);
+  std::pair<AIG::Lit, uint64_t> getTermLit(naja::DNL::DNLID termID);
+  std::pair<AIG::Lit, uint64_t> buildDriver(naja::DNL::DNLID driver);
+  // Compiled function of the driver's cell output and its hash
+  std::pair<const CellFunction*, uint64_t> getCellFunction(
+      naja::DNL::DNLID driver);
+
+  const naja::DNL::DNLFull& dnl_;
+  const std::vector<size_t>& varIDs_;
+  AIG& aig_;
+  std::vector<bool> PIs_;
+  std::vector<bool> POs_;
+  std::pair<naja::DNL::DNLID, naja::DNL::DNLID> topTerms_;
+  std::vector<naja::DNL::DNLID> termInstances_;  // leaf instance by term
+  const std::vector<uint64_t>* inputHashes_ = nullptr;
+  std::vector<AIG::Lit> isoLits_;
+  std::vector<uint64_t> isoHashes_;
+  std::map<std::pair<const naja::NL::SNLDesign*, uint32_t>,
+           std::pair<const CellFunction*, uint64_t>>
+      cellFunctions_;
+  // cell function and input literals -> output literal
+  using CellKey = std::pair<const CellFunction*, std::vector<AIG::Lit>>;
+  struct CellKeyHash {
+    size_t operator()(const CellKey& key) const;
+  };
+  std::unordered_map<CellKey, AIG::Lit, CellKeyHash> cellLits_;
+  std::vector<bool> onPath_;  // isos being expanded, to report loops
+  size_t numExpandedDrivers_ = 0;
+  size_t numStrashedDrivers_ = 0;
+};
+
+}  // namespace KEPLER_FORMAL
@@ -0,0 +1,89 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "SNLTruthTablePool.h"
+#include <tbb/concurrent_unordered_map.h>
+#include <tbb/concurrent_vector.h>
+#include <cassert>
+#include <vector>
+
+using namespace KEPLER_FORMAL;
+using naja::NL::SNLTruthTable;
+
+namespace {
+
+struct TableKey {
+  uint32_t numVars;
+  std::vector<uint64_t> words;
+  bool operator==(const TableKey& other) const {
+    return numVars == other.numVars && words == other.words;
+  }
+};
+
+struct TableKeyHasher {
+  size_t operator()(const TableKey& k) const noexcept {
+    uint64_t x = 0x9e3779b97f4a7c15ULL ^ k.numVars;
+    for (uint64_t w : k.words) {
+      x ^= w + 0x9e3779b97f4a7c15ULL + (x << 6) + (x >> 2);
+    }
+    return static_cast<size_t>(x ^ (x >> 32));
+  }
+};
+
+}  // namespace
+
+struct SNLTruthTablePool::Impl {
+  struct Entry {
+    SNLTruthTable table;
+    CellFunction function;
+  };
+  tbb::concurrent_vector<Entry> entries;
+  tbb::concurrent_unordered_map<TableKey, uint32_t, TableKeyHasher> indexes;
+};
+
+SNLTruthTablePool::Impl& SNLTruthTablePool::impl() {
+  static Impl instance;
+  return instance;
+}
+
+uint32_t SNLTruthTablePool::intern(const SNLTruthTable& table) {
+  if (!table.isInitialized()) {
+    return kNoTable;
+  }
+  TableKey key{table.size(), {}};
+  const uint64_t rows = uint64_t{1} << table.size();
+  key.words.assign((rows + 63) / 64, 0);
+  for (uint64_t m = 0; m < rows; ++m) {
+    if (table.bits().bit(m)) key.words[m >> 6] |= uint64_t{1} << (m & 63);
+  }
+  auto& pool = impl();
+  auto it = pool.indexes.find(key);
+  if (it != pool.indexes.end()) {
+    return it->second;
+  }
+  const auto entry = pool.entries.push_back(
+      {table, CellFunction::compile(table.size(), key.words)});
+  const uint32_t index =
+      static_cast<uint32_t>(entry - pool.entries.begin());
+  // if another thread interned the same table concurrently, use its entry
+  return pool.indexes.insert({std::move(key), index}).first->second;
+}
+
+const SNLTruthTable& SNLTruthTablePool::get(uint32_t index) {
+  assert(index < impl().entries.size());
+  return impl().entries[index].table;
+}
+
+const CellFunction& SNLTruthTablePool::getFunction(uint32_t index) {
+  assert(index < impl().entries.size());
+  return impl().entries[index].function;
+}
+
+size_t SNLTruthTablePool::size() {
+  return impl().indexes.size();
+}
+
+void SNLTruthTablePool::destroy() {
+  impl().indexes.clear();
+  impl().entries.clear();
+}
@@ -0,0 +1,40 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include "CellFunction.h"
+#include "SNLTruthTable.h"
+
+namespace KEPLER_FORMAL {
+
+/// Process-wide pool of the cell functions of truth-table trees.
+///
+/// Table nodes reference their function by index instead of holding a copy,
+/// and tables equal in content share one entry, so a cone of a million
+/// instances of a few hundred cells keeps a few hundred tables. Each entry is
+/// compiled into a CellFunction when first interned, which every instance
+/// then reuses. Entries are never moved: references returned by get() and
+/// getFunction() stay valid until destroy(), and interning is safe from
+/// concurrent builders.
+class SNLTruthTablePool {
+ public:
+  static constexpr uint32_t kNoTable = std::numeric_limits<uint32_t>::max();
+
+  // Index of the entry equal to `table`; kNoTable for an uninitialized one
+  static uint32_t intern(const naja::NL::SNLTruthTable& table);
+  static const naja::NL::SNLTruthTable& get(uint32_t index);
+  static const CellFunction& getFunction(uint32_t index);
+  static size_t size();
+  // Only while no tree references the pool
+  static void destroy();
+
+ private:
+  struct Impl;
+  static Impl& impl();
+};
+
+}  // namespace KEPLER_FORMAL
@@ -11,6 +11,7 @@
 #include <stdexcept>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 
 using namespace KEPLER_FORMAL;
 
@@ -27,6 +28,18 @@ using namespace KEPLER_FORMAL;
 // Init Ptable holder
 const SNLTruthTable SNLTruthTableTree::PtableHolder_ = SNLTruthTable(1, 2);
 
+namespace {
+
+// Nodes come from the scalable allocator, as their id vectors do
+template <typename... Args>
+std::shared_ptr<SNLTruthTableTree::Node> makeNode(Args&&... args) {
+  return std::allocate_shared<SNLTruthTableTree::Node>(
+      tbb::tbb_allocator<SNLTruthTableTree::Node>(),
+      std::forward<Args>(args)...);
+}
+
+}  // namespace
+
 // diagnostic global
 static std::atomic<size_t> g_live_nodes{0};
 
@@ -69,13 +82,13 @@ SNLTruthTableTree::Node::Node(SNLTruthTableTree* t,
   if (tree)
     nodeID = (uint32_t)tree->lastID_++;
   if (type == Type::Table) {
-    truthTable = SNLDesignModeling::getTruthTable(naja::DNL::get()
+    setTruthTable(SNLDesignModeling::getTruthTable(naja::DNL::get()
                                              ->getDNLTerminalFromID(data.termid)
                                              .getDNLInstance()
                                              .getSNLModel(), naja::DNL::get()
                                     ->getDNLTerminalFromID(data.termid)
                                     .getSnlBitTerm()
-                                    ->getOrderID());
+                                    ->getOrderID()));
   }
 }
 
@@ -90,12 +103,12 @@ SNLTruthTableTree::Node::~Node() {
 //----------------------------------------------------------------------
 const SNLTruthTable& SNLTruthTableTree::Node::getTruthTable() const {
   if (type == Type::Table) {
-    if (!truthTable.isInitialized()) {
+    if (tableIndex == SNLTruthTablePool::kNoTable) {
       // LCOV_EXCL_START
       throw std::logic_error("getTruthTable: uninitialized Table node");
       // LCOV_EXCL_STOP
     }
-    return truthTable;
+    return SNLTruthTablePool::get(tableIndex);
   } else if (type == Type::P || type == Type::Input) {
     return PtableHolder_;
   }
@@ -104,6 +117,24 @@ const SNLTruthTable& SNLTruthTableTree::Node::getTruthTable() const {
   // LCOV_EXCL_STOP
 }
 
+void SNLTruthTableTree::Node::setTruthTable(const SNLTruthTable& table) {
+  tableIndex = SNLTruthTablePool::intern(table);
+}
+
+const CellFunction& SNLTruthTableTree::Node::getFunction() const {
+  if (type == Type::Table) {
+    if (tableIndex == SNLTruthTablePool::kNoTable) {
+      // LCOV_EXCL_START
+      throw std::logic_error("getFunction: uninitialized Table node");
+      // LCOV_EXCL_STOP
+    }
+    return SNLTruthTablePool::getFunction(tableIndex);
+  }
+  // P and Input nodes pass their input through, as PtableHolder_
+  static const CellFunction identity = CellFunction::compile(1, {0b10});
+  return identity;
+}
+
 static std::shared_ptr<SNLTruthTableTree::Node> nullNodePtr = nullptr;
 
 //----------------------------------------------------------------------
@@ -244,16 +275,16 @@ void SNLTruthTableTree::updateBorderLeaves() {
   std::vector<uint32_t> stk;
   stk.reserve(64);
   stk.push_back(rootId_);
-  std::set<uint32_t> visited;
+  std::vector<bool> visited(nodes_.size() + kIdOffset, false);
   while (!stk.empty()) {
     uint32_t nid = stk.back();
     stk.pop_back();
-    if (visited.find(nid) != visited.end())
-      continue;
-    visited.insert(nid);
     auto nsp = nodeFromId(nid);
     if (!nsp)
       assert(false && "updateBorderLeaves: null node in tree");
+    if (visited[nid])
+      continue;
+    visited[nid] = true;
     assert(nsp->childrenIds.size() > 0);
     for (size_t i = 0; i < nsp->childrenIds.size(); ++i) {
       uint32_t cid = nsp->childrenIds[i];
@@ -302,12 +333,12 @@ SNLTruthTableTree::SNLTruthTableTree()
 SNLTruthTableTree::SNLTruthTableTree(naja::DNL::DNLID instid,
                                      naja::DNL::DNLID termid,
                                      Node::Type type) {
-  auto rootNode = std::make_shared<Node>(this, instid, termid, type);
+  auto rootNode = makeNode(this, instid, termid, type);
   uint32_t id = allocateNode(rootNode);
   rootId_ = id;
 
   if (type == Node::Type::P || type == Node::Type::Input) {
-    auto inNode = std::make_shared<Node>(0u, this);
+    auto inNode = makeNode(0u, this);
     uint32_t inId = allocateNode(inNode);
     rootNode->childrenIds.push_back(inId);
     inNode->parentIds.push_back(rootId_);
@@ -321,7 +352,7 @@ SNLTruthTableTree::SNLTruthTableTree(naja::DNL::DNLID instid,
 
   auto arity = table.size();
   for (uint32_t i = 0; i < arity; ++i) {
-    auto inNode = std::make_shared<Node>(i, this);
+    auto inNode = makeNode(i, this);
     uint32_t inId = allocateNode(inNode);
     rootNode->childrenIds.push_back(inId);
     inNode->parentIds.push_back(rootId_);
@@ -380,9 +411,8 @@ const SNLTruthTableTree::Node& SNLTruthTableTree::concatBody(
   uint32_t arity = 1;
   std::shared_ptr<Node> newNodeSp;
   if (instid != naja::DNL::DNLID_MAX) {
-    newNodeSp = std::make_shared<Node>(this, instid, termid, Node::Type::Table);
-    const auto& tbl = newNodeSp->getTruthTable();
-    arity = tbl.size();
+    // look for the node of the terminal before building one, which costs a
+    // truth-table lookup
     auto iter = termid2nodeid_.find(termid);
     if (iter != termid2nodeid_.end()) {
       DEBUG_LOG(
@@ -415,9 +445,11 @@ const SNLTruthTableTree::Node& SNLTruthTableTree::concatBody(
       }
       return *newNodeSp;
     }
+    newNodeSp = makeNode(this, instid, termid, Node::Type::Table);
+    arity = newNodeSp->getTruthTable().size();
   } else {
     arity = 1;
-    newNodeSp = std::make_shared<Node>(this, instid, termid, Node::Type::P);
+    newNodeSp = makeNode(this, instid, termid, Node::Type::P);
   }
 
   uint32_t newNodeId = allocateNode(newNodeSp);
@@ -441,7 +473,7 @@ const SNLTruthTableTree::Node& SNLTruthTableTree::concatBody(
 
   if (newNodeSp->type == Node::Type::Table) {
     for (uint32_t i = 1; i < arity; ++i) {
-      auto inNode = std::make_shared<Node>(numExternalInputs_, this);
+      auto inNode = makeNode(numExternalInputs_, this);
       numExternalInputs_++;
       uint32_t inId = allocateNode(inNode);
       newNodeSp->childrenIds.push_back(inId);
@@ -1005,138 +1037,100 @@ void SNLTruthTableTree::destroy() {
 // finalize: repair and validation after construction
 //----------------------------------------------------------------------
 void SNLTruthTableTree::finalize() {
-  // Build resolver maps for existing nodes based on current fields.
-  // We accept that builders may have used:
+  // Builders may have used:
   //  - correct nodeID values (index+kIdOffset)
   //  - debug nodeID values (node->nodeID)
   //  - temporary or precomputed ids (which may be wrong)
   //
   // Strategy:
-  // 1) Create maps: by current nodeID (if valid), by nodeID (debug), and by
-  // slot index. 2) For each node, resolve each childrenIds entry by attempting:
-  //      a) match by nodeID (fast)
-  //      b) match by nodeID (fallback)
-  //      c) interpret as index (cid - kIdOffset) within range
-  //    If resolved, record target shared_ptr.
-  // 3) After all children resolved, rebuild nodes_ canonical ordering (keep
-  // existing order),
-  //    set node->nodeID = index + kIdOffset, set node->tree = this, and replace
-  //    childrenIds with canonical ids derived from the resolved shared_ptrs.
+  // 1) Map current nodeIDs to slots in a flat table.
+  // 2) Resolve each childrenIds entry to a slot, by nodeID first, then as an
+  //    index (cid - kIdOffset); the slots are gathered in one CSR array.
+  // 3) Set node->nodeID = slot + kIdOffset, node->tree = this, and rewrite
+  //    childrenIds from the resolved slots.
   //
   // This repairs common builder mistakes without requiring edits in builder
-  // code.
+  // code, and allocates a handful of flat arrays whatever the tree size.
 
   // Step 0: quick sanity for root
   if (rootId_ == kInvalidId && nodes_.empty())
     return;
 
-  // Build lookup maps
-  std::unordered_map<uint32_t, std::shared_ptr<Node>> mapById;
-  std::unordered_map<uint32_t, std::shared_ptr<Node>> mapByNodeID;
-  mapById.reserve(nodes_.size() * 2);
-  mapByNodeID.reserve(nodes_.size() * 2);
-
-  for (size_t i = 0; i < nodes_.size(); ++i) {
-    auto sp = nodes_[i];
-    if (!sp)
-      continue;
+  const size_t numNodes = nodes_.size();
+  constexpr uint32_t kNoSlot = kInvalidId;
+  uint32_t maxId = 0;
+  for (const auto& sp : nodes_) {
     if (sp->nodeID != kInvalidId)
-      mapById[sp->nodeID] = sp;
-    if (sp->nodeID != 0)
-      mapByNodeID[sp->nodeID] = sp;
+      maxId = std::max(maxId, sp->nodeID);
+  }
+  // last writer wins on duplicate ids
+  std::vector<uint32_t> idToSlot(size_t{maxId} + 1, kNoSlot);
+  uint32_t invalidIdSlot = kNoSlot;
+  for (size_t i = 0; i < numNodes; ++i) {
+    const uint32_t id = nodes_[i]->nodeID;
+    if (id != kInvalidId)
+      idToSlot[id] = static_cast<uint32_t>(i);
+    else
+      invalidIdSlot = static_cast<uint32_t>(i);
   }
+  auto slotOfId = [&](uint32_t id) {
+    if (id == kInvalidId)
+      return invalidIdSlot;
+    return id <= maxId ? idToSlot[id] : kNoSlot;
+  };
 
-  // Resolve children entries to shared_ptrs for every node
-  std::vector<std::vector<std::shared_ptr<Node>>> resolvedChildren(
-      nodes_.size());
-  for (size_t i = 0; i < nodes_.size(); ++i) {
-    auto sp = nodes_[i];
-    if (!sp)
-      continue;
-    resolvedChildren[i].reserve(sp->childrenIds.size());
+  // Resolve children entries to slots, CSR by parent slot
+  std::vector<uint32_t> childOffsets(numNodes + 1, 0);
+  std::vector<uint32_t> childSlots;
+  for (size_t i = 0; i < numNodes; ++i) {
+    childOffsets[i + 1] =
+        childOffsets[i] + static_cast<uint32_t>(nodes_[i]->childrenIds.size());
+  }
+  childSlots.reserve(childOffsets[numNodes]);
+  for (size_t i = 0; i < numNodes; ++i) {
+    const auto& sp = nodes_[i];
     for (size_t j = 0; j < sp->childrenIds.size(); ++j) {
       uint32_t cid = sp->childrenIds[j];
-      std::shared_ptr<Node> target;
-
-      // try match by exact nodeID
-      auto it = mapById.find(cid);
-      if (it != mapById.end())
-        target = it->second;
-      // fallback: match by debug nodeID
-      if (!target) {
-        auto it2 = mapByNodeID.find(cid);
-        if (it2 != mapByNodeID.end())
-          target = it2->second;
-      }
+      uint32_t target = slotOfId(cid);
       // fallback: interpret as index (cid - kIdOffset)
-      if (!target) {
-        if (cid >= kIdOffset) {
-          size_t idx = (size_t)(cid - kIdOffset);
-          if (idx < nodes_.size()) {
-            target = nodes_[idx];
-          }
-        }
+      if (target == kNoSlot && cid >= kIdOffset && cid != kInvalidId &&
+          cid - kIdOffset < numNodes) {
+        target = cid - kIdOffset;
       }
-      if (!target) {
+      if (target == kNoSlot) {
         // LCOV_EXCL_START
         // cannot resolve child id: report and abort
         fprintf(stderr,
                 "finalize: could not resolve child reference: parent_slot=%zu "
                 "parent_assigned_id=%u childPos=%zu childId=%u nodes=%zu\n",
-                i, sp->nodeID, j, cid, nodes_.size());
+                i, sp->nodeID, j, cid, numNodes);
         throw std::logic_error("finalize: unresolved child id");
         // LCOV_EXCL_STOP
       }
-      resolvedChildren[i].push_back(target);
+      childSlots.push_back(target);
     }
   }
 
-  // Now assign canonical ids and remap childrenIds/parentId
-  for (size_t i = 0; i < nodes_.size(); ++i) {
-    uint32_t canonicalId = static_cast<uint32_t>(i) + kIdOffset;
-    auto sp = nodes_[i];
-    sp->nodeID = canonicalId;
-    sp->tree = this;
-  }
+  // Resolve the root before ids change
+  uint32_t rootSlot = kNoSlot;
+  if (rootId_ != kInvalidId)
+    rootSlot = slotOfId(rootId_);
 
-  // Build reverse map from shared_ptr pointer (address) to canonical id
-  std::unordered_map<const Node*, uint32_t> ptrToId;
-  ptrToId.reserve(nodes_.size() * 2);
-  for (size_t i = 0; i < nodes_.size(); ++i) {
-    auto sp = nodes_[i];
-    if (!sp)
-      continue;
-    ptrToId[sp.get()] = static_cast<uint32_t>(i) + kIdOffset;
+  // Now assign canonical ids
+  for (size_t i = 0; i < numNodes; ++i) {
+    nodes_[i]->nodeID = static_cast<uint32_t>(i) + kIdOffset;
+    nodes_[i]->tree = this;
   }
 
-  // Replace childrenIds with canonical ids and set parentId accordingly
-  for (size_t i = 0; i < nodes_.size(); ++i) {
-    auto sp = nodes_[i];
-    sp->childrenIds.clear();
-    sp->childrenIds.reserve(resolvedChildren[i].size());
-    for (size_t j = 0; j < resolvedChildren[i].size(); ++j) {
-      auto targ = resolvedChildren[i][j];
-      auto it = ptrToId.find(targ.get());
-      if (it == ptrToId.end()) {
-        // LCOV_EXCL_START
-        fprintf(stderr,
-                "finalize: internal error mapping ptr->id parent_slot=%zu "
-                "childPos=%zu\n",
-                i, j);
-        throw std::logic_error("finalize: internal mapping failed");
-        // LCOV_EXCL_STOP
-      }
-      uint32_t newCid = it->second;
-      sp->childrenIds.push_back(newCid);
-      // set child's parentId; last writer wins (ok for tree)
-      auto childSp = targ;
-      // replace the slot in the index that contain the value i in parentIds
-      // with the sp->nodeID
-      auto iter = std::find(childSp->parentIds.begin(),
-                            childSp->parentIds.end(), sp->nodeID);
-      if (iter != childSp->parentIds.end()) {
-        *iter = sp->nodeID;
-      } else {
+  // Replace childrenIds with canonical ids; each child must list its parent
+  for (size_t i = 0; i < numNodes; ++i) {
+    const auto& sp = nodes_[i];
+    for (uint32_t k = childOffsets[i]; k < childOffsets[i + 1]; ++k) {
+      const uint32_t target = childSlots[k];
+      sp->childrenIds[k - childOffsets[i]] = target + kIdOffset;
+      const auto& childSp = nodes_[target];
+      if (std::find(childSp->parentIds.begin(), childSp->parentIds.end(),
+                    sp->nodeID) == childSp->parentIds.end()) {
         // LCOV_EXCL_START
         throw std::logic_error("finalize: parentIds inconsistent");
         // LCOV_EXCL_STOP
@@ -1144,41 +1138,29 @@ void SNLTruthTableTree::finalize() {
     }
   }
 
-  // Recompute rootId_: if existing rootId_ was resolvable, remap it; otherwise
-  // try to keep slot 0
+  // Recompute rootId_: remap the previous root if it was resolvable,
+  // otherwise keep slot 0
   if (rootId_ != kInvalidId) {
-    // try to remap previous rootId_ by matching to new canonical id via
-    // mapById/mapByNodeID/slot heuristic
-    uint32_t newRoot = kInvalidId;
-    auto itRoot = mapById.find(rootId_);
-    if (itRoot != mapById.end()) {
-      auto sp = itRoot->second;
-      auto pit = ptrToId.find(sp.get());
-      if (pit != ptrToId.end())
-        newRoot = pit->second;
-    }
-    if (newRoot == kInvalidId) {
-      // fallback: if nodes_[0] exists, use that
-      if (!nodes_.empty() && nodes_[0])
-        newRoot = nodes_[0]->nodeID;
-    }
-    rootId_ = newRoot;
+    if (rootSlot != kNoSlot)
+      rootId_ = rootSlot + kIdOffset;
+    else if (numNodes != 0)
+      rootId_ = kIdOffset;
+    else
+      rootId_ = kInvalidId;
   }
 
   // Recompute numExternalInputs_ by scanning leaves
-  size_t maxInput = 0;
   numExternalInputs_ = 0;
-  bool anyInput = false;
   std::vector<uint32_t> stk;
   if (rootId_ != kInvalidId)
     stk.push_back(rootId_);
-  std::set<uint32_t> visited;
+  std::vector<bool> visited(numNodes + kIdOffset, false);
   while (!stk.empty()) {
     uint32_t nid = stk.back();
     stk.pop_back();
-    if (visited.count(nid))
+    if (visited[nid])
       continue;
-    visited.insert(nid);
+    visited[nid] = true;
     auto n = nodeFromId(nid);
     if (!n)
       continue;
@@ -1188,16 +1170,12 @@ void SNLTruthTableTree::finalize() {
       if (!ch)
         continue;
       if (ch->type == Node::Type::Input || ch->type == Node::Type::P) {
-        anyInput = true;
-        // if (ch->data.inputIndex > maxInput) maxInput = ch->data.inputIndex;
         numExternalInputs_++;
       } else {
         stk.push_back(cid);
       }
     }
   }
-  // if (anyInput) numExternalInputs_ = maxInput + 1;
-  // else numExternalInputs_ = 0;
 
   updateBorderLeaves();
 }
@@ -5,6 +5,7 @@
 #define SNLTRUTHTABLETREE_H
 
 #include "SNLTruthTable.h"
+#include "SNLTruthTablePool.h"
 #include <vector>
 #include <memory>
 #include <cstddef>
@@ -24,6 +25,8 @@ public:
   struct Node {
     // group 32-bit scalars first
   uint32_t nodeID   = std::numeric_limits<uint32_t>::max();
+  // function of a Table node in SNLTruthTablePool
+  uint32_t tableIndex = SNLTruthTablePool::kNoTable;
   //uint32_t parentId = std::numeric_limits<uint32_t>::max();
   std::vector<uint32_t, tbb::tbb_allocator<uint32_t>> parentIds; // for multiple parents support
 
@@ -34,8 +37,6 @@ public:
     naja::DNL::DNLID termid; // 64-bit
   } data;
 
-  SNLTruthTable truthTable; 
-
   SNLTruthTableTree* tree = nullptr; // 8 bytes
   std::vector<uint32_t, tbb::tbb_allocator<uint32_t>> childrenIds; // typically 24 bytes on LP64
 
@@ -54,6 +55,9 @@ public:
     bool eval(const std::vector<bool>& extInputs) const;
     void addChildId(uint32_t childId);
     const SNLTruthTable& getTruthTable() const;
+    void setTruthTable(const SNLTruthTable& table);
+    // Compiled form of getTruthTable(), shared by every node of the table
+    const CellFunction& getFunction() const;
   };
 
   static constexpr uint32_t kReservedId0 = 0u;
@@ -7,6 +7,7 @@
 #include <string>
 #include <vector>
 
+#include "AIG.h"
 #include "BoolExpr.h"
 #include "SNLTruthTableTree.h"
 
@@ -17,6 +18,10 @@ class Tree2BoolExpr {
  public:
   static std::shared_ptr<BoolExpr> convert(const SNLTruthTableTree& tree,
                                            const std::vector<size_t>& varNames);
+  /// Same conversion emitted into an AIG; returns the literal of the root
+  static AIG::Lit convert(const SNLTruthTableTree& tree,
+                          const std::vector<size_t>& varNames,
+                          AIG& aig);
 };
 
 }  // namespace KEPLER_FORMAL
@@ -0,0 +1,198 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "AIG.h"
+#include <tbb/parallel_invoke.h>
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <utility>
+#include "BoolExpr.h"
+
+namespace KEPLER_FORMAL {
+
+AIG::AIG() {
+  // Node 0: constant false
+  nodes_.push_back({0, 0});
+}
+
+AIG::Lit AIG::createInput(size_t varId) {
+  if (varId == 0) return kFalse;
+  if (varId == 1) return kTrue;
+  // var ids are dense (normalized input index + 2): index them directly
+  if (varId < var2node_.size() && var2node_[varId] != kInputMark) {
+    return makeLit(var2node_[varId]);
+  }
+  assert(varId < kInputMark);
+  uint32_t node = static_cast<uint32_t>(nodes_.size());
+  nodes_.push_back({kInputMark, static_cast<Lit>(varId)});
+  if (varId >= var2node_.size()) {
+    var2node_.resize(std::max(varId + 1, 2 * var2node_.size()), kInputMark);
+  }
+  var2node_[varId] = node;
+  ++numInputs_;
+  return makeLit(node);
+}
+
+AIG::Lit AIG::createAnd(Lit a, Lit b) {
+  if (b < a) std::swap(a, b);
+  if (a == kFalse) return kFalse;
+  if (a == kTrue) return b;
+  if (a == b) return a;
+  if (a == negate(b)) return kFalse;
+
+  auto it = strash_.find(strashKey(a, b));
+  if (it != strash_.end()) {
+    return makeLit(it->second);
+  }
+  uint32_t node = static_cast<uint32_t>(nodes_.size());
+  if (node >= (kInputMark >> 1)) {
+    // LCOV_EXCL_START
+    throw std::overflow_error("AIG: too many nodes for 32-bit literals");
+    // LCOV_EXCL_STOP
+  }
+  nodes_.push_back({a, b});
+  strash_.emplace(strashKey(a, b), node);
+  return makeLit(node);
+}
+
+AIG::Lit AIG::createXor(Lit a, Lit b) {
+  if (a == kFalse) return b;
+  if (b == kFalse) return a;
+  if (a == kTrue) return negate(b);
+  if (b == kTrue) return negate(a);
+  if (a == b) return kFalse;
+  if (a == negate(b)) return kTrue;
+  return createOr(createAnd(a, negate(b)), createAnd(negate(a), b));
+}
+
+std::vector<AIG::Lit> AIG::append(const AIG& other) {
+  std::vector<Lit> map(other.nodes_.size(), kNoLit);
+  map[0] = kFalse;
+  for (uint32_t n = 1; n < other.nodes_.size(); ++n) {
+    const Node& node = other.nodes_[n];
+    if (node.fanin0 == kInputMark) {
+      map[n] = createInput(node.fanin1);
+    } else {
+      map[n] = createAnd(remapLit(map, node.fanin0), remapLit(map, node.fanin1));
+    }
+  }
+  return map;
+}
+
+namespace {
+
+// Merges parts [lo, hi) into parts[lo], both halves being reduced in parallel.
+void mergeRange(std::vector<AIG>& parts,
+                std::vector<std::vector<AIG::Lit>>& lits,
+                size_t lo,
+                size_t hi) {
+  if (hi - lo <= 1) return;
+  size_t mid = lo + (hi - lo) / 2;
+  tbb::parallel_invoke([&] { mergeRange(parts, lits, lo, mid); },
+                       [&] { mergeRange(parts, lits, mid, hi); });
+  auto map = parts[lo].append(parts[mid]);
+  // parts[mid] carries the literals of the whole [mid, hi) range by now
+  for (size_t p = mid; p < hi; ++p) {
+    for (auto& lit : lits[p]) {
+      lit = AIG::remapLit(map, lit);
+    }
+  }
+  parts[mid] = AIG();
+}
+
+}  // namespace
+
+AIG AIG::merge(std::vector<AIG>& parts, std::vector<std::vector<Lit>>& lits) {
+  assert(parts.size() == lits.size());
+  if (parts.empty()) return AIG();
+  mergeRange(parts, lits, 0, parts.size());
+  return std::move(parts[0]);
+}
+
+AIG::Lit AIG::importBoolExpr(const std::shared_ptr<BoolExpr>& expr) {
+  std::unordered_map<const BoolExpr*, Lit> memo;
+  std::vector<std::pair<const BoolExpr*, bool>> stk;
+  stk.emplace_back(expr.get(), false);
+  while (!stk.empty()) {
+    auto [e, expanded] = stk.back();
+    if (memo.count(e)) {
+      stk.pop_back();
+      continue;
+    }
+    if (e->getOp() == Op::VAR) {
+      stk.pop_back();
+      memo[e] = createInput(e->getId());
+      continue;
+    }
+    if (!expanded) {
+      stk.back().second = true;
+      if (e->getRight()) stk.emplace_back(e->getRight().get(), false);
+      stk.emplace_back(e->getLeft().get(), false);
+      continue;
+    }
+    stk.pop_back();
+    Lit l = memo.at(e->getLeft().get());
+    Lit r = e->getRight() ? memo.at(e->getRight().get()) : kFalse;
+    switch (e->getOp()) {
+      case Op::NOT: memo[e] = negate(l); break;
+      case Op::AND: memo[e] = createAnd(l, r); break;
+      case Op::OR:  memo[e] = createOr(l, r); break;
+      case Op::XOR: memo[e] = createXor(l, r); break;
+      default:
+        throw std::logic_error("importBoolExpr: unhandled operator");
+    }
+  }
+  return memo.at(expr.get());
+}
+
+std::shared_ptr<BoolExpr> AIG::toBoolExpr(Lit lit) const {
+  std::vector<std::shared_ptr<BoolExpr>> memo(nodes_.size());
+  memo[0] = BoolExpr::createFalse();
+  std::vector<uint32_t> stk{getNode(lit)};
+  while (!stk.empty()) {
+    uint32_t n = stk.back();
+    if (memo[n]) {
+      stk.pop_back();
+      continue;
+    }
+    if (isInput(n)) {
+      memo[n] = BoolExpr::Var(getInputVarId(n));
+      stk.pop_back();
+      continue;
+    }
+    uint32_t n0 = getNode(nodes_[n].fanin0);
+    uint32_t n1 = getNode(nodes_[n].fanin1);
+    if (!memo[n0] || !memo[n1]) {
+      if (!memo[n0]) stk.push_back(n0);
+      if (!memo[n1]) stk.push_back(n1);
+      continue;
+    }
+    stk.pop_back();
+    auto f0 = isComplemented(nodes_[n].fanin0) ? BoolExpr::Not(memo[n0]) : memo[n0];
+    auto f1 = isComplemented(nodes_[n].fanin1) ? BoolExpr::Not(memo[n1]) : memo[n1];
+    memo[n] = BoolExpr::And(f0, f1);
+  }
+  auto e = memo[getNode(lit)];
+  return isComplemented(lit) ? BoolExpr::Not(e) : e;
+}
+
+AIG::Lit createBalancedOr(AIG& aig, std::vector<AIG::Lit> lits) {
+  if (lits.empty()) {
+    return AIG::kFalse;
+  }
+  // pairwise reduction, one tree level per pass
+  while (lits.size() > 1) {
+    size_t out = 0;
+    for (size_t i = 0; i + 1 < lits.size(); i += 2) {
+      lits[out++] = aig.createOr(lits[i], lits[i + 1]);
+    }
+    if (lits.size() % 2) {
+      lits[out++] = lits.back();
+    }
+    lits.resize(out);
+  }
+  return lits[0];
+}
+
+}  // namespace KEPLER_FORMAL
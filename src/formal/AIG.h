@@ -0,0 +1,103 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace KEPLER_FORMAL {
+
+class BoolExpr;
+
+/// Contiguous And-Inverter Graph addressed by 32-bit literals.
+///
+/// A literal is (node index << 1) | complemented. Node 0 is the constant, so
+/// literal 0 is false and literal 1 is true. Inputs are keyed by the same var
+/// ids as BoolExpr (0/1 constants, i + 2 for normalized input i), which lets
+/// graphs built for the two designs share their inputs when merged. AND nodes
+/// are structurally hashed and always appended after their fanins, so the node
+/// array is in topological order.
+///
+/// An AIG is not thread-safe: build one per thread and merge them afterwards.
+class AIG {
+ public:
+  using Lit = uint32_t;
+
+  static constexpr Lit kFalse = 0;
+  static constexpr Lit kTrue = 1;
+  static constexpr Lit kNoLit = UINT32_MAX;
+
+  static Lit makeLit(uint32_t node, bool complemented = false) {
+    return (node << 1) | (complemented ? 1 : 0);
+  }
+  static uint32_t getNode(Lit lit) { return lit >> 1; }
+  static bool isComplemented(Lit lit) { return (lit & 1) != 0; }
+  static Lit negate(Lit lit) { return lit ^ 1; }
+
+  AIG();
+
+  // Factories (constant folding, trivial simplification, strash)
+  Lit createInput(size_t varId);
+  Lit createNot(Lit a) const { return negate(a); }
+  Lit createAnd(Lit a, Lit b);
+  Lit createOr(Lit a, Lit b) { return negate(createAnd(negate(a), negate(b))); }
+  Lit createXor(Lit a, Lit b);
+
+  // Accessors
+  size_t getNumNodes() const { return nodes_.size(); }
+  size_t getNumInputs() const { return numInputs_; }
+  size_t getNumAnds() const { return nodes_.size() - numInputs_ - 1; }
+  bool isConst(uint32_t node) const { return node == 0; }
+  bool isInput(uint32_t node) const {
+    return node != 0 && nodes_[node].fanin0 == kInputMark;
+  }
+  bool isAnd(uint32_t node) const {
+    return node != 0 && nodes_[node].fanin0 != kInputMark;
+  }
+  Lit getFanin0(uint32_t node) const { return nodes_[node].fanin0; }
+  Lit getFanin1(uint32_t node) const { return nodes_[node].fanin1; }
+  size_t getInputVarId(uint32_t node) const { return nodes_[node].fanin1; }
+
+  // Copies `other` into this graph, sharing inputs by var id and strashing
+  // against existing logic. Returns the new literal of each node of `other`.
+  std::vector<Lit> append(const AIG& other);
+
+  // Translates a literal of an appended graph through the map from append().
+  static Lit remapLit(const std::vector<Lit>& map, Lit lit) {
+    return map[getNode(lit)] ^ (lit & 1);
+  }
+
+  // Merges per-thread graphs by pairwise parallel reduction. lits[p] holds
+  // literals of parts[p] and is rewritten in place into the merged graph.
+  // The parts are consumed.
+  static AIG merge(std::vector<AIG>& parts,
+                   std::vector<std::vector<Lit>>& lits);
+
+  // Conversions with the shared_ptr representation
+  Lit importBoolExpr(const std::shared_ptr<BoolExpr>& expr);
+  std::shared_ptr<BoolExpr> toBoolExpr(Lit lit) const;
+
+ private:
+  struct Node {
+    Lit fanin0;
+    Lit fanin1;  // var id for inputs
+  };
+  static constexpr Lit kInputMark = UINT32_MAX;
+
+  static uint64_t strashKey(Lit a, Lit b) { return (uint64_t(a) << 32) | b; }
+
+  std::vector<Node> nodes_;
+  std::unordered_map<uint64_t, uint32_t> strash_;
+  std::vector<uint32_t> var2node_;  // input node by var id, kInputMark if none
+  size_t numInputs_ = 0;
+};
+
+// OR of `lits` as a balanced tree: log2(n) levels instead of the n of a
+// chain. The empty OR is kFalse.
+AIG::Lit createBalancedOr(AIG& aig, std::vector<AIG::Lit> lits);
+
+}  // namespace KEPLER_FORMAL
@@ -4,16 +4,10 @@
 #include "BoolExpr.h"
 #include <cassert>
 #include <unordered_map>
+#include <vector>
 
 namespace KEPLER_FORMAL {
 
-// static definitions
-tbb::concurrent_unordered_map<BoolExprCache::Key,
-                   std::weak_ptr<BoolExpr>,
-                   BoolExpr::KeyHash,
-                   BoolExpr::KeyEq>
-    BoolExpr::table_{};
-
 /// Private ctor
 BoolExpr::BoolExpr(Op op, size_t id,
                    const std::shared_ptr<BoolExpr>& a,
@@ -37,25 +31,6 @@ BoolExpr::BoolExpr(Op op, size_t id,
 /// Intern+construct a new node if needed
 std::shared_ptr<BoolExpr>
 BoolExpr::createNode(BoolExprCache::Key const& k) {
-    // Caller already holds lock on tableMutex_
-    // print the size in GB of table_
-    //printf("BoolExpr table size: %.2f GB\n",
-    //       (table_.size() * (sizeof(Key) + sizeof(std::weak_ptr<BoolExpr>))) / (1024.0*1024.0*1024.0));
-
-    /*auto it = table_.find(k);
-    if (it != table_.end()) {
-        if (auto existing = it->second.lock())
-            return existing;
-    }
-    // retrieve shared_ptr to children via non-const shared_from_this()
-    std::shared_ptr<BoolExpr> L = k.l ? k.l->shared_from_this() : nullptr;
-    std::shared_ptr<BoolExpr> R = k.r ? k.r->shared_from_this() : nullptr;
-
-    auto ptr = std::shared_ptr<BoolExpr>(
-        new BoolExpr(k.op, k.varId, std::move(L), std::move(R))
-    );
-    table_.emplace(k, ptr);
-    return ptr;*/
     return BoolExprCache::getExpression(k);
 }
 
@@ -173,7 +148,51 @@ std::string BoolExpr::toString() const     {
     Print(oss);
     return oss.str();
 }
-//bool BoolExpr::evaluate(const std::unordered_map<size_t,bool>& env) const { /* … */ }
+bool BoolExpr::evaluate(const std::unordered_map<size_t,bool>& env) const {
+    // Iterative post-order with memo, safe on deep DAGs
+    std::unordered_map<const BoolExpr*, bool> memo;
+    std::vector<std::pair<const BoolExpr*, bool>> stk;
+    stk.emplace_back(this, false);
+    while (!stk.empty()) {
+        auto [node, expanded] = stk.back();
+        if (memo.count(node)) {
+            stk.pop_back();
+            continue;
+        }
+        if (node->op_ == Op::VAR) {
+            stk.pop_back();
+            if (node->varID_ == 0 || node->varID_ == 1) {
+                memo[node] = node->varID_ == 1;
+            } else {
+                auto it = env.find(node->varID_);
+                if (it == env.end())
+                    throw std::out_of_range("evaluate: unassigned var " +
+                                            std::to_string(node->varID_));
+                memo[node] = it->second;
+            }
+            continue;
+        }
+        if (!expanded) {
+            stk.back().second = true;
+            if (node->right_) stk.emplace_back(node->right_.get(), false);
+            stk.emplace_back(node->left_.get(), false);
+            continue;
+        }
+        stk.pop_back();
+        bool l = memo.at(node->left_.get());
+        bool r = node->right_ ? memo.at(node->right_.get()) : false;
+        switch (node->op_) {
+            case Op::NOT: memo[node] = !l; break;
+            case Op::AND: memo[node] = l && r; break;
+            case Op::OR:  memo[node] = l || r; break;
+            case Op::XOR: memo[node] = l != r; break;
+            default:
+                throw std::logic_error("evaluate: unhandled operator");
+        }
+    }
+    return memo.at(this);
+}
+
 std::string BoolExpr::OpToString(Op op) { 
     switch (op) {
         case Op::VAR: return "VAR";
@@ -12,7 +12,6 @@
 #include <stdexcept>
 #include <unordered_map>
 #include "BoolExprCache.h"
-#include "tbb/concurrent_unordered_map.h"
 
 namespace KEPLER_FORMAL {
 
@@ -100,46 +99,7 @@ class BoolExpr : public std::enable_shared_from_this<BoolExpr> {
 
   static std::string OpToString(Op);
 
-  static constexpr uint64_t HASH_SEED = 0x9e3779b97f4a7c15ULL;
-
-  static inline uint64_t splitmix64(uint64_t x) noexcept {
-    x += 0x9e3779b97f4a7c15ULL;
-    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
-    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
-    return x ^ (x >> 31);
-  }
-  struct KeyHash {
-    size_t operator()(BoolExprCache::Key const& k) const noexcept {
-      const uint64_t s = HASH_SEED;
-      uint64_t a = splitmix64(uint64_t(std::hash<int>()(int(k.op))) + s);
-      uint64_t b =
-          splitmix64(uint64_t(std::hash<size_t>()(k.varId)) ^ (s << 1));
-      uint64_t c = splitmix64(uint64_t(std::uintptr_t(k.l.get())) + (s >> 1));
-      uint64_t d = splitmix64(uint64_t(std::uintptr_t(k.r.get())) ^ (s << 2));
-      uint64_t acc = a;
-      acc = splitmix64(acc ^
-                       (b + 0x9e3779b97f4a7c15ULL + (acc << 6) + (acc >> 2)));
-      acc ^= (c + 0x9e3779b97f4a7c15ULL + (acc << 6) + (acc >> 2));
-      acc = splitmix64(acc ^ d);
-      return static_cast<size_t>(acc);
-    }
-  };
-  struct KeyEq {
-    bool operator()(BoolExprCache::Key const& a,
-                    BoolExprCache::Key const& b) const noexcept {
-      return a.op == b.op && a.varId == b.varId && a.l == b.l && a.r == b.r;
-    }
-  };
-
-  // Global weak-map: BoolExprCache::Key → shared instance
-  // guarded by tableMutex_ on every access
-  static tbb::concurrent_unordered_map<BoolExprCache::Key,
-                                       std::weak_ptr<BoolExpr>,
-                                       KeyHash,
-                                       KeyEq>
-      table_;
-
-  // Interning constructor (caller must lock tableMutex_)
+  // Interned node for the key, see BoolExprCache
   static std::shared_ptr<BoolExpr> createNode(BoolExprCache::Key const& k);
 };
 
@@ -2,22 +2,25 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
 #include "BoolExprCache.h"
-#include <tbb/concurrent_unordered_map.h>
+#include <tbb/enumerable_thread_specific.h>
 #include <tbb/tbb_allocator.h>
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <memory>
+#include <mutex>
 #include <tuple>
+#include <unordered_map>
+#include <vector>
 #include "BoolExpr.h"
 
 namespace KEPLER_FORMAL {
 
-// atomic id counter
-std::atomic<size_t> BoolExprCache::lastID_{1};
-size_t BoolExprCache::numMiss_ = 0;
-size_t BoolExprCache::numQuaries_ = 0;
-size_t BoolExprCache::numHit_ = 0;
+std::atomic<size_t> BoolExprCache::numReclaimed_{0};
+
+namespace {
 
 // Tuple key: (op,varId,lid,rid) using pointer identity for children
 using TupleKey = std::tuple<uint32_t, uint64_t, uint64_t, uint64_t>;
@@ -38,36 +41,32 @@ struct TupleKeyHasher {
   }
 };
 
-struct TupleKeyEq {
-  bool operator()(TupleKey const& a, TupleKey const& b) const noexcept {
-    return a == b;
-  }
-};
-
-using ValueT = std::shared_ptr<BoolExpr>;
+using ValueT = std::weak_ptr<BoolExpr>;
 using PairT = std::pair<const TupleKey, ValueT>;
 using TbbAlloc = tbb::tbb_allocator<PairT>;
 
-// concurrent map using tbb allocator
-using SingleMap = tbb::concurrent_unordered_map<TupleKey,
-                                                ValueT,
-                                                TupleKeyHasher,
-                                                TupleKeyEq,
-                                                TbbAlloc>;
-
-struct BoolExprCache::Impl {
-  SingleMap table;
+using ShardMap = std::unordered_map<TupleKey,
+                                    ValueT,
+                                    TupleKeyHasher,
+                                    std::equal_to<TupleKey>,
+                                    TbbAlloc>;
+
+// A shard is swept once it holds this many entries, then once it has doubled
+constexpr size_t kMinSweepSize = 1024;
+constexpr size_t kNumShards = 256;
+// Direct-mapped entries of the per-thread front table
+constexpr size_t kFrontSize = size_t{1} << 12;
+
+struct Shard {
+  std::mutex mutex;
+  ShardMap table;
+  size_t sweepAt = kMinSweepSize;
 };
 
-BoolExprCache::Impl& BoolExprCache::impl() {
-  static Impl instance;
-  return instance;
-}
-
-static inline TupleKey make_tuple_key(Op op,
-                                      size_t varId,
-                                      const std::shared_ptr<BoolExpr>& lptr,
-                                      const std::shared_ptr<BoolExpr>& rptr) noexcept {
+inline TupleKey make_tuple_key(Op op,
+                               size_t varId,
+                               const std::shared_ptr<BoolExpr>& lptr,
+                               const std::shared_ptr<BoolExpr>& rptr) noexcept {
   // use pointer identity as integer; nullptr -> 0
   auto lid = reinterpret_cast<uint64_t>(lptr.get());
   auto rid = reinterpret_cast<uint64_t>(rptr.get());
@@ -75,18 +74,44 @@ static inline TupleKey make_tuple_key(Op op,
                   rid};
 }
 
+struct FrontEntry {
+  TupleKey key;
+  ValueT node;
+};
+
+// Per-thread state: recent lookups, answered without locking, and counters
+// only the owning thread writes
+struct Local {
+  std::vector<FrontEntry> front{kFrontSize};
+  size_t generation = 0;
+  size_t numQueries = 0;
+  size_t numHits = 0;
+  size_t numFrontHits = 0;
+};
+
+}  // namespace
+
+struct BoolExprCache::Impl {
+  std::array<Shard, kNumShards> shards;
+  tbb::enumerable_thread_specific<Local> locals;
+  // Bumped by destroy() so that front tables drop nodes the shards forgot
+  std::atomic<size_t> generation{0};
+};
+
+BoolExprCache::Impl& BoolExprCache::impl() {
+  static Impl instance;
+  return instance;
+}
+
 std::shared_ptr<BoolExpr> BoolExprCache::getExpression(Key const& k) {
-  std::shared_ptr<BoolExpr> lptr = k.l;
-  std::shared_ptr<BoolExpr> rptr = k.r;
-  TupleKey tk = make_tuple_key(k.op, k.varId, lptr, rptr);
+  const std::shared_ptr<BoolExpr>& lptr = k.l;
+  const std::shared_ptr<BoolExpr>& rptr = k.r;
+  TupleKey tk;
   if (k.l == nullptr || k.r == nullptr) {
     if (k.l == nullptr) {
       tk = make_tuple_key(k.op, k.varId, rptr, nullptr);
-    } else if (k.r == nullptr) {
-      tk = make_tuple_key(k.op, k.varId, lptr, nullptr);
     } else {
-      // both null
-      tk = make_tuple_key(k.op, k.varId, nullptr, nullptr);
+      tk = make_tuple_key(k.op, k.varId, lptr, nullptr);
     }
   } else if (*k.l <= *k.r) {
     // enforce canonical order for commutative ops
@@ -95,55 +120,93 @@ std::shared_ptr<BoolExpr> BoolExprCache::getExpression(Key const& k) {
     tk = make_tuple_key(k.op, k.varId, lptr, rptr);
   }
 
-  auto& tbl = impl().table;
-
-  numQuaries_ += 1;
-  // quick lookup
-  auto it = tbl.find(tk);
-  if (it != tbl.end()) {
-    size_t id = lastID_.fetch_add(1, std::memory_order_relaxed) + 1;
-    // it->second->setIndex(id);
-    assert(it->second != nullptr);
-    numHit_ += 1;
-    // printf("######### numHit: %lu\n", numHit_);
-    return it->second;
+  const size_t hash = TupleKeyHasher()(tk);
+  Impl& cache = impl();
+  Local& local = cache.locals.local();
+  ++local.numQueries;
+  const size_t generation = cache.generation.load(std::memory_order_acquire);
+  if (local.generation != generation) {
+    std::fill(local.front.begin(), local.front.end(), FrontEntry());
+    local.generation = generation;
+  }
+  FrontEntry& front = local.front[hash % kFrontSize];
+  if (front.key == tk) {
+    if (std::shared_ptr<BoolExpr> existing = front.node.lock()) {
+      ++local.numHits;
+      ++local.numFrontHits;
+      return existing;
+    }
   }
 
-  // construct new BoolExpr. We need shared_ptr owners for children if they
-  // exist.
-  std::shared_ptr<BoolExpr> L = lptr ? lptr : nullptr;
-  std::shared_ptr<BoolExpr> R = rptr ? rptr : nullptr;
-
-  // use new because constructor may be non-public
-  std::shared_ptr<BoolExpr> newptr(new BoolExpr(k.op, k.varId, L, R));
+  // the low bits select the bucket inside the shard
+  Shard& shard = cache.shards[(hash >> 32) % kNumShards];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto [it, inserted] = shard.table.try_emplace(tk);
+  if (!inserted) {
+    if (std::shared_ptr<BoolExpr> existing = it->second.lock()) {
+      ++local.numHits;
+      front = FrontEntry{tk, it->second};
+      return existing;
+    }
+  }
 
-  // assign id atomically
-  size_t id = lastID_.fetch_add(1, std::memory_order_relaxed) + 1;
-  // newptr->setIndex(id);
+  // Separate allocation: with make_shared the node storage would stay
+  // allocated until the weak entry is swept. The constructor is private.
+  std::shared_ptr<BoolExpr> node(new BoolExpr(k.op, k.varId, lptr, rptr));
+  it->second = node;
+  front = FrontEntry{tk, node};
+
+  if (shard.table.size() >= shard.sweepAt) {
+    const size_t before = shard.table.size();
+    std::erase_if(shard.table,
+                  [](const PairT& entry) { return entry.second.expired(); });
+    numReclaimed_.fetch_add(before - shard.table.size(),
+                            std::memory_order_relaxed);
+    shard.sweepAt = std::max(kMinSweepSize, 2 * shard.table.size());
+  }
+  return node;
+}
 
-  // insert; if another thread inserted concurrently, use that one
-  auto pr = tbl.insert({tk, newptr});
-  // print size of cache
+size_t BoolExprCache::getNumQueries() {
+  size_t n = 0;
+  for (const Local& local : impl().locals) {
+    n += local.numQueries;
+  }
+  return n;
+}
 
-  if (!pr.second) {
-    // delete newptr;
-    //  destroy newptr
+size_t BoolExprCache::getNumHits() {
+  size_t n = 0;
+  for (const Local& local : impl().locals) {
+    n += local.numHits;
+  }
+  return n;
+}
 
-    return pr.first->second;
+size_t BoolExprCache::getNumFrontHits() {
+  size_t n = 0;
+  for (const Local& local : impl().locals) {
+    n += local.numFrontHits;
   }
-  numMiss_ += 1;
-  // printf("miss rate: %lf\n", (double) numHit_ / (double) numMiss_);
-  // printf("size of cache: %lu\n", tbl.size());
+  return n;
+}
 
-  return newptr;
+size_t BoolExprCache::getNumEntries() {
+  size_t n = 0;
+  for (Shard& shard : impl().shards) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    n += shard.table.size();
+  }
+  return n;
 }
 
 void BoolExprCache::destroy() {
-  // delete all stored std::shared_ptr<BoolExpr>
-  // for (auto& kv : impl().table) {
-  //   delete kv.second;
-  // }
-  impl().table.clear();
+  impl().generation.fetch_add(1, std::memory_order_acq_rel);
+  for (Shard& shard : impl().shards) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.table.clear();
+    shard.sweepAt = kMinSweepSize;
+  }
 }
 
 }  // namespace KEPLER_FORMAL
@@ -23,6 +23,17 @@ struct BoolExprCacheKey {
   const std::shared_ptr<BoolExpr>& r;  // raw pointer
 };
 
+/// Hash-consing table of BoolExpr nodes.
+///
+/// Entries hold their node weakly: a node lives as long as an expression
+/// (a primary output root, a memo entry...) references it, and a lookup that
+/// finds an expired entry builds the node again. Children are part of the key
+/// by address, which is safe since a live node keeps its children alive. The
+/// table is split into shards, each with its own lock; a shard drops its
+/// expired entries when it has doubled since its last sweep, so the table
+/// stays proportional to the live nodes. Each thread first looks in a small
+/// direct-mapped table of its recent lookups, which needs no lock: a cone
+/// converted by one thread mostly queries nodes that thread just built.
 class BoolExprCache {
  public:
   using Key = BoolExprCacheKey;
@@ -31,14 +42,21 @@ class BoolExprCache {
   static std::shared_ptr<BoolExpr> getExpression(Key const& k);
   static void destroy();
 
+  // Lookup statistics since the start of the process, summed over the
+  // per-thread counters; exact once the building threads are idle
+  static size_t getNumQueries();
+  static size_t getNumHits();
+  // Hits answered by the per-thread table, included in getNumHits()
+  static size_t getNumFrontHits();
+  // Entries currently in the table, expired ones included
+  static size_t getNumEntries();
+  // Expired entries dropped by the sweeps since the start of the process
+  static size_t getNumReclaimed() { return numReclaimed_; }
+
  private:
   struct Impl;
   static Impl& impl();
-  // destructor that will delete all stored std::shared_ptr<BoolExpr>
-  static std::atomic<size_t> lastID_;
-  static size_t numQuaries_;
-  static size_t numMiss_;
-  static size_t numHit_;
+  static std::atomic<size_t> numReclaimed_;
 };
 
 }  // namespace KEPLER_FORMAL
@@ -0,0 +1,234 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "BoolExprSimulator.h"
+#include "Concurrency.h"
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <utility>
+
+namespace KEPLER_FORMAL {
+
+namespace {
+
+inline uint64_t mix64(uint64_t x) noexcept {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+}  // namespace
+
+uint64_t BoolExprSimulator::inputWord(uint64_t seed, size_t varId,
+                                      size_t word) {
+  return mix64(mix64(seed ^ (uint64_t(varId) * 0xff51afd7ed558ccdULL)) +
+               uint64_t(word));
+}
+
+uint32_t BoolExprSimulator::flatten(const BoolExpr* root) {
+  auto found = node2index_.find(root);
+  if (found != node2index_.end()) {
+    return found->second;
+  }
+  // Iterative post-order so that children always get smaller indexes
+  std::vector<std::pair<const BoolExpr*, bool>> stk;
+  stk.emplace_back(root, false);
+  while (!stk.empty()) {
+    auto [e, expanded] = stk.back();
+    if (node2index_.count(e)) {
+      stk.pop_back();
+      continue;
+    }
+    const BoolExpr* l = e->getLeft().get();
+    const BoolExpr* r = e->getRight().get();
+    if (!expanded) {
+      stk.back().second = true;
+      if (r != nullptr && !node2index_.count(r)) {
+        stk.emplace_back(r, false);
+      }
+      if (l != nullptr && !node2index_.count(l)) {
+        stk.emplace_back(l, false);
+      }
+      continue;
+    }
+    stk.pop_back();
+    Node n{e->getOp(), 0, 0, 0};
+    if (n.op == Op::VAR) {
+      n.varId = e->getId();
+    } else {
+      n.left = node2index_.at(l);
+      n.right = r != nullptr ? node2index_.at(r) : n.left;
+    }
+    node2index_[e] = static_cast<uint32_t>(nodes_.size());
+    nodes_.push_back(n);
+  }
+  return node2index_.at(root);
+}
+
+size_t BoolExprSimulator::addRoot(const std::shared_ptr<BoolExpr>& root) {
+  assert(root != nullptr);
+  heldRoots_.push_back(root);
+  roots_.push_back(flatten(root.get()));
+  return roots_.size() - 1;
+}
+
+uint32_t BoolExprSimulator::flatten(const AIG& aig, AIG::Lit root) {
+  if (aig_ != &aig) {
+    aig_ = &aig;
+    aigLit2index_.clear();
+  }
+  aigLit2index_.resize(2 * aig.getNumNodes(), kUnset);
+  // Complemented literals become NOT nodes, created on first use
+  auto litIndex = [&](AIG::Lit lit) {
+    if (aigLit2index_[lit] == kUnset) {
+      uint32_t pos = aigLit2index_[AIG::negate(lit)];
+      assert(pos != kUnset);
+      aigLit2index_[lit] = static_cast<uint32_t>(nodes_.size());
+      nodes_.push_back({Op::NOT, pos, pos, 0});
+    }
+    return aigLit2index_[lit];
+  };
+  std::vector<uint32_t> stk{AIG::getNode(root)};
+  while (!stk.empty()) {
+    uint32_t n = stk.back();
+    AIG::Lit pos = AIG::makeLit(n);
+    if (aigLit2index_[pos] != kUnset) {
+      stk.pop_back();
+      continue;
+    }
+    Node node{Op::VAR, 0, 0, 0};
+    if (aig.isInput(n)) {
+      node.varId = aig.getInputVarId(n);
+    } else if (aig.isAnd(n)) {
+      uint32_t n0 = AIG::getNode(aig.getFanin0(n));
+      uint32_t n1 = AIG::getNode(aig.getFanin1(n));
+      bool ready = true;
+      if (aigLit2index_[AIG::makeLit(n0)] == kUnset) {
+        stk.push_back(n0);
+        ready = false;
+      }
+      if (aigLit2index_[AIG::makeLit(n1)] == kUnset) {
+        stk.push_back(n1);
+        ready = false;
+      }
+      if (!ready) continue;
+      node.op = Op::AND;
+      node.left = litIndex(aig.getFanin0(n));
+      node.right = litIndex(aig.getFanin1(n));
+    }
+    stk.pop_back();
+    aigLit2index_[pos] = static_cast<uint32_t>(nodes_.size());
+    nodes_.push_back(node);
+  }
+  return litIndex(root);
+}
+
+size_t BoolExprSimulator::addRoot(const AIG& aig, AIG::Lit root) {
+  roots_.push_back(flatten(aig, root));
+  return roots_.size() - 1;
+}
+
+void BoolExprSimulator::run(size_t numWords, uint64_t seed) {
+  numWords_ = numWords;
+  seed_ = seed;
+  signatures_.assign(roots_.size() * numWords_, 0);
+
+  tbb::enumerable_thread_specific<std::vector<uint64_t>> values(
+      [&] { return std::vector<uint64_t>(nodes_.size()); });
+  auto simulateWord = [&](size_t w) {
+    std::vector<uint64_t>& val = values.local();
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+      const Node& n = nodes_[i];
+      switch (n.op) {
+        case Op::VAR:
+          if (n.varId == 0) {
+            val[i] = 0;
+          } else if (n.varId == 1) {
+            val[i] = ~uint64_t(0);
+          } else {
+            val[i] = inputWord(seed_, n.varId, w);
+          }
+          break;
+        case Op::NOT:
+          val[i] = ~val[n.left];
+          break;
+        case Op::AND:
+          val[i] = val[n.left] & val[n.right];
+          break;
+        case Op::OR:
+          val[i] = val[n.left] | val[n.right];
+          break;
+        case Op::XOR:
+          val[i] = val[n.left] ^ val[n.right];
+          break;
+        default:
+          assert(false && "Unhandled operator in BoolExprSimulator");
+          break;
+      }
+    }
+    for (size_t r = 0; r < roots_.size(); ++r) {
+      signatures_[r * numWords_ + w] = val[roots_[r]];
+    }
+  };
+
+  if (!Concurrency::isParallel()) {
+    for (size_t w = 0; w < numWords_; ++w) {
+      simulateWord(w);
+    }
+  } else {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numWords_),
+                      [&](const tbb::blocked_range<size_t>& r) {
+                        for (size_t w = r.begin(); w < r.end(); ++w) {
+                          simulateWord(w);
+                        }
+                      });
+  }
+}
+
+size_t BoolExprSimulator::firstDifference(size_t root0, size_t root1) const {
+  const uint64_t* s0 = getSignature(root0);
+  const uint64_t* s1 = getSignature(root1);
+  for (size_t w = 0; w < numWords_; ++w) {
+    uint64_t diff = s0[w] ^ s1[w];
+    if (diff != 0) {
+      return w * 64 + __builtin_ctzll(diff);
+    }
+  }
+  return (size_t)-1;
+}
+
+std::vector<size_t> BoolExprSimulator::getSupport(
+    const std::vector<size_t>& roots) const {
+  std::vector<char> seen(nodes_.size(), 0);
+  std::vector<uint32_t> stk;
+  std::vector<size_t> support;
+  for (size_t root : roots) {
+    stk.push_back(roots_[root]);
+  }
+  while (!stk.empty()) {
+    uint32_t i = stk.back();
+    stk.pop_back();
+    if (seen[i]) {
+      continue;
+    }
+    seen[i] = 1;
+    const Node& n = nodes_[i];
+    if (n.op == Op::VAR) {
+      if (n.varId > 1) {
+        support.push_back(n.varId);
+      }
+      continue;
+    }
+    stk.push_back(n.left);
+    stk.push_back(n.right);
+  }
+  std::sort(support.begin(), support.end());
+  return support;
+}
+
+}  // namespace KEPLER_FORMAL
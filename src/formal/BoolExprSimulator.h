@@ -0,0 +1,85 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "AIG.h"
+#include "BoolExpr.h"
+
+namespace KEPLER_FORMAL {
+
+/// Bit-parallel random simulator over BoolExpr DAGs.
+///
+/// Roots are flattened once into a topologically ordered node array shared by
+/// all of them, then simulated 64 patterns at a time. Input words are a pure
+/// function of (seed, var id, word index), so expressions built over the same
+/// normalized var ids (both sides of a miter) see the same stimulus without
+/// any input vector being stored. AIG literals are accepted as roots too.
+class BoolExprSimulator {
+ public:
+  BoolExprSimulator() = default;
+
+  // Registers a root to simulate and returns its index.
+  size_t addRoot(const std::shared_ptr<BoolExpr>& root);
+  // Same for a literal of `aig`, which must outlive the flattening calls.
+  size_t addRoot(const AIG& aig, AIG::Lit root);
+
+  // Simulates numWords * 64 patterns; parallel over words (see Concurrency).
+  void run(size_t numWords, uint64_t seed = kDefaultSeed);
+
+  size_t getNumRoots() const { return roots_.size(); }
+  size_t getNumWords() const { return numWords_; }
+  size_t getNumNodes() const { return nodes_.size(); }
+
+  // Simulation result of a root, numWords words.
+  const uint64_t* getSignature(size_t root) const {
+    return signatures_.data() + root * numWords_;
+  }
+
+  // Index of the first pattern on which the two roots differ, or -1.
+  size_t firstDifference(size_t root0, size_t root1) const;
+
+  // Var ids (constants excluded) reachable from the given roots, sorted.
+  std::vector<size_t> getSupport(const std::vector<size_t>& roots) const;
+
+  // Value of var `varId` in pattern `pattern` of the last run.
+  bool getInputValue(size_t varId, size_t pattern) const {
+    return (inputWord(seed_, varId, pattern / 64) >> (pattern % 64)) & 1;
+  }
+
+  static uint64_t inputWord(uint64_t seed, size_t varId, size_t word);
+
+  static constexpr uint64_t kDefaultSeed = 0x5eed0f4e91e2ULL;
+
+ private:
+  struct Node {
+    Op op;
+    uint32_t left;
+    uint32_t right;
+    size_t varId;
+  };
+
+  uint32_t flatten(const BoolExpr* root);
+  uint32_t flatten(const AIG& aig, AIG::Lit root);
+
+  static constexpr uint32_t kUnset = UINT32_MAX;
+
+  std::vector<Node> nodes_;
+  std::unordered_map<const BoolExpr*, uint32_t> node2index_;
+  // node2index_ is keyed by address: the roots are held so that no flattened
+  // node is freed and its address reused by a later root
+  std::vector<std::shared_ptr<BoolExpr>> heldRoots_;
+  const AIG* aig_ = nullptr;
+  std::vector<uint32_t> aigLit2index_;
+  std::vector<uint32_t> roots_;
+  std::vector<uint64_t> signatures_;  // root-major, numWords_ per root
+  size_t numWords_ = 0;
+  uint64_t seed_ = kDefaultSeed;
+};
+
+}  // namespace KEPLER_FORMAL
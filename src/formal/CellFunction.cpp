@@ -0,0 +1,142 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "CellFunction.h"
+#include <bit>
+#include <cassert>
+#include <utility>
+
+using namespace KEPLER_FORMAL;
+
+namespace {
+
+// OR of `terms` as a balanced tree, see createBalancedOr()
+std::shared_ptr<BoolExpr> balancedOr(
+    std::vector<std::shared_ptr<BoolExpr>> terms) {
+  if (terms.empty()) {
+    return BoolExpr::createFalse();
+  }
+  while (terms.size() > 1) {
+    size_t out = 0;
+    for (size_t i = 0; i + 1 < terms.size(); i += 2) {
+      terms[out++] = BoolExpr::Or(terms[i], terms[i + 1]);
+    }
+    if (terms.size() % 2) {
+      terms[out++] = terms.back();
+    }
+    terms.resize(out);
+  }
+  return terms[0];
+}
+
+}  // namespace
+
+CellFunction CellFunction::compile(uint32_t numInputs,
+                                   std::vector<uint64_t> words) {
+  CellFunction function;
+  function.numInputs = numInputs;
+  function.words = std::move(words);
+  const uint64_t rows = uint64_t{1} << numInputs;
+  assert(function.words.size() == (rows + 63) / 64);
+  uint64_t ones = 0;
+  for (uint64_t w : function.words) {
+    ones += std::popcount(w);
+  }
+  if (ones == 0 || ones == rows) {
+    function.isConstant = true;
+    function.constantValue = ones != 0;
+    return function;
+  }
+  for (uint32_t j = 0; j < numInputs; ++j) {
+    for (uint64_t m = 0; m < rows; ++m) {
+      if (function.getBit(m) != function.getBit(m ^ (uint64_t{1} << j))) {
+        function.support.push_back(j);
+        break;
+      }
+    }
+  }
+  function.cover = TruthTableCoverCache::get(numInputs, function.words);
+  if (!function.cover) {
+    // each on-set minterm over the support once, whatever the values of the
+    // inputs the function ignores
+    const size_t supportSize = function.support.size();
+    std::vector<char> seen(size_t{1} << supportSize, 0);
+    for (uint64_t m = 0; m < rows; ++m) {
+      if (!function.getBit(m)) continue;
+      uint64_t minterm = 0;
+      for (size_t k = 0; k < supportSize; ++k) {
+        minterm |= ((m >> function.support[k]) & 1) << k;
+      }
+      if (!seen[minterm]) {
+        seen[minterm] = 1;
+        function.minterms.push_back(minterm);
+      }
+    }
+  }
+  return function;
+}
+
+AIG::Lit CellFunction::instantiate(const AIG::Lit* inputs, AIG& aig) const {
+  if (isConstant) return constantValue ? AIG::kTrue : AIG::kFalse;
+  if (cover) {
+    AIG::Lit expr = AIG::kFalse;
+    for (const auto& cube : cover->cubes) {
+      AIG::Lit term = AIG::kTrue;
+      for (uint32_t j = 0; j < numInputs; ++j) {
+        if ((cube.pos >> j) & 1) term = aig.createAnd(term, inputs[j]);
+        else if ((cube.neg >> j) & 1) term = aig.createAnd(term, AIG::negate(inputs[j]));
+      }
+      expr = aig.createOr(expr, term);
+    }
+    return cover->complemented ? AIG::negate(expr) : expr;
+  }
+  // sum of the on-set minterms over the support
+  std::vector<AIG::Lit> terms;
+  terms.reserve(minterms.size());
+  for (uint64_t minterm : minterms) {
+    AIG::Lit term = AIG::kTrue;
+    for (size_t k = 0; k < support.size(); ++k) {
+      const AIG::Lit input = inputs[support[k]];
+      term = aig.createAnd(term,
+                           (minterm >> k) & 1 ? input : AIG::negate(input));
+    }
+    terms.push_back(term);
+  }
+  return createBalancedOr(aig, std::move(terms));
+}
+
+std::shared_ptr<BoolExpr> CellFunction::instantiate(
+    const std::shared_ptr<BoolExpr>* inputs) const {
+  if (isConstant) {
+    return constantValue ? BoolExpr::createTrue() : BoolExpr::createFalse();
+  }
+  if (cover) {
+    std::shared_ptr<BoolExpr> expr = nullptr;
+    for (const auto& cube : cover->cubes) {
+      std::shared_ptr<BoolExpr> term = nullptr;
+      for (uint32_t j = 0; j < numInputs; ++j) {
+        std::shared_ptr<BoolExpr> lit = nullptr;
+        if ((cube.pos >> j) & 1) lit = inputs[j];
+        else if ((cube.neg >> j) & 1) lit = BoolExpr::Not(inputs[j]);
+        else continue;
+        term = term ? BoolExpr::And(term, lit) : lit;
+      }
+      if (!term) term = BoolExpr::createTrue();
+      expr = expr ? BoolExpr::Or(expr, term) : term;
+    }
+    if (!expr) expr = BoolExpr::createFalse();
+    return cover->complemented ? BoolExpr::Not(expr) : expr;
+  }
+  std::vector<std::shared_ptr<BoolExpr>> terms;
+  terms.reserve(minterms.size());
+  for (uint64_t minterm : minterms) {
+    std::shared_ptr<BoolExpr> term = nullptr;
+    for (size_t k = 0; k < support.size(); ++k) {
+      const auto& input = inputs[support[k]];
+      auto lit = (minterm >> k) & 1 ? input : BoolExpr::Not(input);
+      term = term ? BoolExpr::And(term, lit) : lit;
+    }
+    terms.push_back(term);
+  }
+  return balancedOr(std::move(terms));
+}
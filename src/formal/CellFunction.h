@@ -0,0 +1,44 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "AIG.h"
+#include "BoolExpr.h"
+#include "TruthTableCover.h"
+
+namespace KEPLER_FORMAL {
+
+/// Output function of a cell, compiled once for all its instances.
+///
+/// The table becomes a constant, an ISOP cover shared through
+/// TruthTableCoverCache or, when it is too wide for covers, the on-set
+/// minterms over the inputs it depends on. An instance only substitutes its
+/// input literals: nothing is derived from the table per instance.
+struct CellFunction {
+  uint32_t numInputs = 0;
+  std::vector<uint64_t> words;  // bit m: value for input assignment m
+  bool isConstant = false;
+  bool constantValue = false;
+  std::shared_ptr<const TruthTableCover> cover;  // nullptr above kMaxVars
+  std::vector<uint32_t> support;  // inputs the function depends on
+  // Without a cover: the distinct on-set minterms over the support, bit k
+  // being the value of input support[k]
+  std::vector<uint64_t> minterms;
+
+  // words holds the 2^numInputs table bits LSB-first, nothing above them
+  static CellFunction compile(uint32_t numInputs, std::vector<uint64_t> words);
+
+  bool getBit(uint64_t m) const { return (words[m >> 6] >> (m & 63)) & 1; }
+
+  // Function of the instance whose input j is inputs[j]
+  AIG::Lit instantiate(const AIG::Lit* inputs, AIG& aig) const;
+  std::shared_ptr<BoolExpr> instantiate(
+      const std::shared_ptr<BoolExpr>* inputs) const;
+};
+
+}  // namespace KEPLER_FORMAL
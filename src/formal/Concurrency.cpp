@@ -0,0 +1,73 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "Concurrency.h"
+#include <tbb/global_control.h>
+#include <tbb/info.h>
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+
+using namespace KEPLER_FORMAL;
+
+namespace {
+
+std::mutex arenaMutex;
+std::unique_ptr<tbb::task_arena> arena;
+// Caps the TBB worker pool as well, so no other arena exceeds the budget
+std::unique_ptr<tbb::global_control> workerLimit;
+
+bool isSequential() {
+  return getenv("KEPLER_NO_MT") != nullptr;
+}
+
+void createArena(size_t threads, int numaNode) {
+  const int concurrency = isSequential() ? 1
+                          : threads == 0 ? tbb::task_arena::automatic
+                                         : static_cast<int>(threads);
+  arena.reset();
+  workerLimit.reset();
+  if (concurrency != tbb::task_arena::automatic) {
+    workerLimit = std::make_unique<tbb::global_control>(
+        tbb::global_control::max_allowed_parallelism, concurrency);
+  }
+  if (numaNode >= 0) {
+    arena = std::make_unique<tbb::task_arena>(
+        tbb::task_arena::constraints(numaNode, concurrency));
+  } else {
+    arena = std::make_unique<tbb::task_arena>(concurrency);
+  }
+  arena->initialize();
+}
+
+}  // namespace
+
+bool Concurrency::configure(size_t threads, int numaNode) {
+  std::lock_guard<std::mutex> lock(arenaMutex);
+  bool pinned = true;
+  if (numaNode >= 0) {
+    const auto nodes = tbb::info::numa_nodes();
+    if (std::find(nodes.begin(), nodes.end(), numaNode) == nodes.end()) {
+      numaNode = -1;
+      pinned = false;
+    }
+  }
+  createArena(threads, numaNode);
+  return pinned;
+}
+
+size_t Concurrency::getNumThreads() {
+  if (isSequential()) {
+    return 1;
+  }
+  return static_cast<size_t>(getArena().max_concurrency());
+}
+
+tbb::task_arena& Concurrency::getArena() {
+  std::lock_guard<std::mutex> lock(arenaMutex);
+  if (!arena) {
+    createArena(0, -1);
+  }
+  return *arena;
+}
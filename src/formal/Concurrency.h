@@ -0,0 +1,39 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <tbb/task_arena.h>
+
+namespace KEPLER_FORMAL {
+
+/// Thread budget of the parallel phases.
+///
+/// Every parallel phase of a run executes in one task arena sized by
+/// configure() (--threads, YAML `threads`), so a job uses the threads it was
+/// given whatever the size of the host. The arena can be pinned to a NUMA
+/// node. KEPLER_NO_MT still selects the sequential code paths, as a budget of
+/// one thread would.
+class Concurrency {
+ public:
+  // threads 0 takes every core (of the NUMA node when pinned), numaNode -1
+  // does not pin. Returns false when TBB does not know the NUMA node, the
+  // arena being left unpinned. Call before the first parallel phase.
+  static bool configure(size_t threads, int numaNode = -1);
+
+  // Concurrency of the arena, 1 under KEPLER_NO_MT
+  static size_t getNumThreads();
+  static bool isParallel() { return getNumThreads() > 1; }
+
+  static tbb::task_arena& getArena();
+
+  // Runs f in the arena and returns its result
+  template <typename F>
+  static auto execute(F&& f) -> decltype(f()) {
+    return getArena().execute(std::forward<F>(f));
+  }
+};
+
+}  // namespace KEPLER_FORMAL
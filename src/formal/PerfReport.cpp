@@ -0,0 +1,166 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "PerfReport.h"
+#include <sys/resource.h>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+
+using namespace KEPLER_FORMAL;
+
+namespace {
+
+struct Entry {
+  std::string name;
+  double seconds;
+  size_t peakRSSKB;
+  PerfReport::Counters counters;
+  std::vector<PerfReport::Counters> calls;
+};
+
+std::atomic<bool> enabled{false};
+std::mutex entriesMutex;
+std::vector<Entry> entries;
+std::chrono::steady_clock::time_point enableTime;
+
+void appendString(std::string& out, const std::string& s) {
+  out += '"';
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char buffer[8];
+      std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+      out += buffer;
+    } else {
+      out += c;
+    }
+  }
+  out += '"';
+}
+
+void appendNumber(std::string& out, double value) {
+  if (!std::isfinite(value)) {
+    out += "null";
+    return;
+  }
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.15g", value);
+  out += buffer;
+}
+
+void appendCounters(std::string& out, const PerfReport::Counters& counters) {
+  out += '{';
+  for (size_t c = 0; c < counters.size(); ++c) {
+    if (c != 0) out += ", ";
+    appendString(out, counters[c].first);
+    out += ": ";
+    appendNumber(out, counters[c].second);
+  }
+  out += '}';
+}
+
+}  // namespace
+
+void PerfReport::Phase::stop() {
+  if (stopped_) return;
+  stopped_ = true;
+  if (!isEnabled()) return;
+  const double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start_)
+                             .count();
+  if (numCalls_ != 0) {
+    counters_.emplace_back("calls", numCalls_);
+  }
+  record(name_, seconds, std::move(counters_), std::move(calls_));
+}
+
+void PerfReport::enable() {
+  std::lock_guard<std::mutex> lock(entriesMutex);
+  if (!enabled) {
+    enableTime = std::chrono::steady_clock::now();
+    enabled = true;
+  }
+}
+
+bool PerfReport::isEnabled() {
+  return enabled.load(std::memory_order_relaxed);
+}
+
+void PerfReport::record(const std::string& name,
+                        double seconds,
+                        Counters counters,
+                        std::vector<Counters> calls) {
+  if (!isEnabled()) return;
+  const size_t peak = getPeakRSSKB();
+  std::lock_guard<std::mutex> lock(entriesMutex);
+  entries.push_back({name, seconds, peak, std::move(counters),
+                     std::move(calls)});
+}
+
+void PerfReport::clear() {
+  std::lock_guard<std::mutex> lock(entriesMutex);
+  entries.clear();
+  enableTime = std::chrono::steady_clock::now();
+}
+
+std::string PerfReport::toJSON() {
+  std::lock_guard<std::mutex> lock(entriesMutex);
+  std::string out = "{\n  \"version\": 1,\n  \"total_seconds\": ";
+  appendNumber(out, std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - enableTime)
+                        .count());
+  out += ",\n  \"peak_rss_kb\": ";
+  appendNumber(out, static_cast<double>(getPeakRSSKB()));
+  out += ",\n  \"phases\": [";
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const Entry& entry = entries[i];
+    out += i == 0 ? "\n    {\"name\": " : ",\n    {\"name\": ";
+    appendString(out, entry.name);
+    out += ", \"seconds\": ";
+    appendNumber(out, entry.seconds);
+    out += ", \"peak_rss_kb\": ";
+    appendNumber(out, static_cast<double>(entry.peakRSSKB));
+    out += ", \"counters\": ";
+    appendCounters(out, entry.counters);
+    if (!entry.calls.empty()) {
+      out += ", \"calls\": [";
+      for (size_t c = 0; c < entry.calls.size(); ++c) {
+        if (c != 0) out += ", ";
+        appendCounters(out, entry.calls[c]);
+      }
+      out += ']';
+    }
+    out += '}';
+  }
+  out += entries.empty() ? "]\n}\n" : "\n  ]\n}\n";
+  return out;
+}
+
+bool PerfReport::write(const std::string& path) {
+  std::ofstream out(path, std::ios::trunc);
+  if (!out) {
+    return false;
+  }
+  out << toJSON();
+  return static_cast<bool>(out);
+}
+
+size_t PerfReport::getPeakRSSKB() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    // LCOV_EXCL_START
+    return 0;
+    // LCOV_EXCL_STOP
+  }
+#ifdef __APPLE__
+  // bytes on macOS, KiB on Linux
+  return static_cast<size_t>(usage.ru_maxrss) / 1024;
+#else
+  return static_cast<size_t>(usage.ru_maxrss);
+#endif
+}
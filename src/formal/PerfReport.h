@@ -0,0 +1,78 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace KEPLER_FORMAL {
+
+/// Machine-readable timings of a run.
+///
+/// Each phase is recorded when it ends, with its wall time, the peak RSS of
+/// the process at that point and its counters (node, clause, conflict
+/// counts...). A phase may also list its calls (one per solver...), each
+/// with its own counters, up to kMaxCalls of them. A phase run several times
+/// gets one entry per run. Nothing is recorded until enable(), so library
+/// users pay nothing for the probes.
+class PerfReport {
+ public:
+  using Counters = std::vector<std::pair<std::string, double>>;
+
+  // Calls listed per phase; later ones are only counted
+  static constexpr size_t kMaxCalls = 256;
+
+  /// Times a phase from construction to stop() or destruction.
+  class Phase {
+   public:
+    explicit Phase(std::string name)
+        : name_(std::move(name)), start_(std::chrono::steady_clock::now()) {}
+    ~Phase() { stop(); }
+    Phase(const Phase&) = delete;
+    Phase& operator=(const Phase&) = delete;
+
+    Phase& add(const std::string& counter, double value) {
+      counters_.emplace_back(counter, value);
+      return *this;
+    }
+    // Lists one call of the phase; the phase counts its calls in "calls"
+    Phase& addCall(Counters call) {
+      if (numCalls_++ < kMaxCalls) {
+        calls_.push_back(std::move(call));
+      }
+      return *this;
+    }
+    // Records the phase now; later calls do nothing
+    void stop();
+
+   private:
+    std::string name_;
+    std::chrono::steady_clock::time_point start_;
+    Counters counters_;
+    std::vector<Counters> calls_;
+    size_t numCalls_ = 0;
+    bool stopped_ = false;
+  };
+
+  static void enable();
+  static bool isEnabled();
+  static void record(const std::string& name,
+                     double seconds,
+                     Counters counters,
+                     std::vector<Counters> calls = {});
+  static void clear();
+
+  // {"version", "total_seconds", "peak_rss_kb", "phases": [...]}, a phase
+  // with calls listing them in "calls": [{counters}...]
+  static std::string toJSON();
+  static bool write(const std::string& path);
+
+  // Peak resident set size of the process so far, in KiB
+  static size_t getPeakRSSKB();
+};
+
+}  // namespace KEPLER_FORMAL
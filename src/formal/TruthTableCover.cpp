@@ -0,0 +1,221 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "TruthTableCover.h"
+#include <tbb/concurrent_unordered_map.h>
+#include <bit>
+#include <cassert>
+#include <stdexcept>
+#include <utility>
+
+namespace KEPLER_FORMAL {
+
+namespace {
+
+using TT = std::vector<uint64_t>;
+
+// Bit positions where input v (v < 6) is 1 inside a word
+constexpr uint64_t kVarMasks[6] = {
+    0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+    0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL};
+
+bool isZero(const TT& f) {
+  for (uint64_t w : f) {
+    if (w != 0) return false;
+  }
+  return true;
+}
+
+bool isOne(const TT& f) {
+  for (uint64_t w : f) {
+    if (w != ~uint64_t(0)) return false;
+  }
+  return true;
+}
+
+// Cofactor of f for input v = value, still expressed over all inputs
+TT cofactor(const TT& f, uint32_t v, bool value) {
+  TT r(f.size());
+  if (v < 6) {
+    const uint64_t m = kVarMasks[v];
+    const unsigned s = 1u << v;
+    for (size_t i = 0; i < f.size(); ++i) {
+      uint64_t w = f[i];
+      r[i] = value ? ((w & m) | ((w & m) >> s)) : ((w & ~m) | ((w & ~m) << s));
+    }
+  } else {
+    const size_t step = size_t{1} << (v - 6);
+    for (size_t i = 0; i < f.size(); ++i) {
+      r[i] = f[value ? (i | step) : (i & ~step)];
+    }
+  }
+  return r;
+}
+
+bool dependsOn(const TT& f, uint32_t v) {
+  if (v < 6) {
+    const unsigned s = 1u << v;
+    for (uint64_t w : f) {
+      if (((w >> s) ^ w) & ~kVarMasks[v]) return true;
+    }
+    return false;
+  }
+  const size_t step = size_t{1} << (v - 6);
+  for (size_t i = 0; i < f.size(); ++i) {
+    if ((i & step) == 0 && f[i] != f[i | step]) return true;
+  }
+  return false;
+}
+
+uint64_t varWord(uint32_t v, size_t i) {
+  if (v < 6) return kVarMasks[v];
+  return (i & (size_t{1} << (v - 6))) ? ~uint64_t(0) : 0;
+}
+
+// Minato-Morreale: appends to `cubes` a cover C with L <= C <= U, over the
+// inputs below `top`, and returns the function of the appended cubes.
+TT isop(const TT& L, const TT& U, uint32_t top,
+        std::vector<TruthTableCover::Cube>& cubes) {
+  if (isZero(L)) return TT(L.size(), 0);
+  if (isOne(U)) {
+    cubes.push_back({});
+    return TT(L.size(), ~uint64_t(0));
+  }
+  uint32_t v = top;
+  while (v > 0) {
+    --v;
+    if (dependsOn(L, v) || dependsOn(U, v)) break;
+  }
+  assert(dependsOn(L, v) || dependsOn(U, v));
+  TT L0 = cofactor(L, v, false), L1 = cofactor(L, v, true);
+  TT U0 = cofactor(U, v, false), U1 = cofactor(U, v, true);
+  const size_t n = L.size();
+
+  TT tmp(n);
+  for (size_t i = 0; i < n; ++i) tmp[i] = L0[i] & ~U1[i];
+  size_t first = cubes.size();
+  TT R0 = isop(tmp, U0, v, cubes);
+  for (size_t c = first; c < cubes.size(); ++c) cubes[c].neg |= 1u << v;
+
+  for (size_t i = 0; i < n; ++i) tmp[i] = L1[i] & ~U0[i];
+  first = cubes.size();
+  TT R1 = isop(tmp, U1, v, cubes);
+  for (size_t c = first; c < cubes.size(); ++c) cubes[c].pos |= 1u << v;
+
+  TT Ustar(n);
+  for (size_t i = 0; i < n; ++i) {
+    tmp[i] = (L0[i] & ~R0[i]) | (L1[i] & ~R1[i]);
+    Ustar[i] = U0[i] & U1[i];
+  }
+  TT Rstar = isop(tmp, Ustar, v, cubes);
+
+  TT R(n);
+  for (size_t i = 0; i < n; ++i) {
+    uint64_t x = varWord(v, i);
+    R[i] = (R0[i] & ~x) | (R1[i] & x) | Rstar[i];
+  }
+  return R;
+}
+
+struct TableKey {
+  uint32_t numVars;
+  std::vector<uint64_t> words;
+  bool operator==(const TableKey& other) const {
+    return numVars == other.numVars && words == other.words;
+  }
+};
+
+struct TableKeyHasher {
+  size_t operator()(const TableKey& k) const noexcept {
+    uint64_t x = 0x9e3779b97f4a7c15ULL ^ k.numVars;
+    for (uint64_t w : k.words) {
+      x ^= w + 0x9e3779b97f4a7c15ULL + (x << 6) + (x >> 2);
+    }
+    return static_cast<size_t>(x ^ (x >> 32));
+  }
+};
+
+}  // namespace
+
+size_t TruthTableCover::getNumLiterals() const {
+  size_t n = 0;
+  for (const auto& c : cubes) {
+    n += std::popcount(c.pos) + std::popcount(c.neg);
+  }
+  return n;
+}
+
+TruthTableCover TruthTableCover::compute(uint32_t numVars,
+                                         const std::vector<uint64_t>& words) {
+  if (numVars > 32) {
+    // LCOV_EXCL_START
+    throw std::invalid_argument("TruthTableCover: more than 32 inputs");
+    // LCOV_EXCL_STOP
+  }
+  const size_t numWords =
+      numVars <= 6 ? 1 : (size_t{1} << (numVars - 6));
+  if (words.size() != numWords) {
+    // LCOV_EXCL_START
+    throw std::invalid_argument("TruthTableCover: wrong number of words");
+    // LCOV_EXCL_STOP
+  }
+  TT on = words;
+  if (numVars < 6) {
+    // replicate the 2^n meaningful bits over the whole word
+    const unsigned rows = 1u << numVars;
+    uint64_t w = on[0] & ((rows == 64) ? ~uint64_t(0) : ((uint64_t(1) << rows) - 1));
+    for (unsigned s = rows; s < 64; s <<= 1) w |= w << s;
+    on[0] = w;
+  }
+  TT off(on.size());
+  for (size_t i = 0; i < on.size(); ++i) off[i] = ~on[i];
+
+  TruthTableCover onCover;
+  isop(on, on, numVars, onCover.cubes);
+  TruthTableCover offCover;
+  offCover.complemented = true;
+  isop(off, off, numVars, offCover.cubes);
+  // AND/OR count of a cover is about its literal count; ties keep the on-set
+  if (offCover.getNumLiterals() < onCover.getNumLiterals()) {
+    return offCover;
+  }
+  return onCover;
+}
+
+struct TruthTableCoverCache::Impl {
+  tbb::concurrent_unordered_map<TableKey,
+                                std::shared_ptr<const TruthTableCover>,
+                                TableKeyHasher>
+      table;
+};
+
+TruthTableCoverCache::Impl& TruthTableCoverCache::impl() {
+  static Impl instance;
+  return instance;
+}
+
+std::shared_ptr<const TruthTableCover> TruthTableCoverCache::get(
+    uint32_t numVars,
+    const std::vector<uint64_t>& words) {
+  if (numVars > kMaxVars) return nullptr;
+  TableKey key{numVars, words};
+  auto& tbl = impl().table;
+  auto it = tbl.find(key);
+  if (it != tbl.end()) {
+    return it->second;
+  }
+  auto cover = std::make_shared<const TruthTableCover>(
+      TruthTableCover::compute(numVars, words));
+  // if another thread inserted concurrently, use that one
+  return tbl.insert({std::move(key), cover}).first->second;
+}
+
+size_t TruthTableCoverCache::size() {
+  return impl().table.size();
+}
+
+void TruthTableCoverCache::destroy() {
+  impl().table.clear();
+}
+
+}  // namespace KEPLER_FORMAL
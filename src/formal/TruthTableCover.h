@@ -0,0 +1,52 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace KEPLER_FORMAL {
+
+/// Irredundant sum-of-products cover of a truth table (Minato-Morreale ISOP).
+///
+/// Covers of the on-set and of the off-set are both computed and the cheaper
+/// one is kept; `complemented` tells that the cubes describe the negated
+/// function. Only support variables appear in the cubes.
+struct TruthTableCover {
+  struct Cube {
+    uint32_t pos = 0;  // bit j: input j appears uncomplemented
+    uint32_t neg = 0;  // bit j: input j appears complemented
+  };
+  std::vector<Cube> cubes;
+  bool complemented = false;
+
+  size_t getNumLiterals() const;
+
+  // Computes the cover of a table given LSB-first in 64-bit words: bit m is
+  // the value for input assignment m. Tables under 6 inputs use one word.
+  static TruthTableCover compute(uint32_t numVars,
+                                 const std::vector<uint64_t>& words);
+};
+
+/// Process-wide cache of covers keyed by table content, so each distinct
+/// cell function is factored once however many instances use it.
+class TruthTableCoverCache {
+ public:
+  // Widest table handled; callers fall back to minterm expansion above it.
+  static constexpr uint32_t kMaxVars = 16;
+
+  static std::shared_ptr<const TruthTableCover> get(
+      uint32_t numVars,
+      const std::vector<uint64_t>& words);
+  static size_t size();
+  static void destroy();
+
+ private:
+  struct Impl;
+  static Impl& impl();
+};
+
+}  // namespace KEPLER_FORMAL
@@ -0,0 +1,59 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "AIGCnf.h"
+#include <cstdint>
+
+namespace KEPLER_FORMAL {
+
+Glucose::Lit tseitinEncode(Glucose::SimpSolver& S,
+                           const AIG& aig,
+                           AIG::Lit root,
+                           std::vector<int>& node2var) {
+  node2var.resize(aig.getNumNodes(), -1);
+  auto toLit = [&](AIG::Lit lit) {
+    return Glucose::mkLit(node2var[AIG::getNode(lit)],
+                          AIG::isComplemented(lit));
+  };
+  if (node2var[0] == -1) {
+    // constant node is false
+    node2var[0] = S.newVar();
+    S.addClause(~Glucose::mkLit(node2var[0]));
+  }
+
+  std::vector<uint32_t> stk{AIG::getNode(root)};
+  while (!stk.empty()) {
+    uint32_t n = stk.back();
+    if (node2var[n] != -1) {
+      stk.pop_back();
+      continue;
+    }
+    if (aig.isInput(n)) {
+      node2var[n] = S.newVar();
+      stk.pop_back();
+      continue;
+    }
+    // First time we see this node, push the fanins not encoded yet
+    uint32_t n0 = AIG::getNode(aig.getFanin0(n));
+    uint32_t n1 = AIG::getNode(aig.getFanin1(n));
+    if (node2var[n0] == -1 || node2var[n1] == -1) {
+      if (node2var[n0] == -1) stk.push_back(n0);
+      if (node2var[n1] == -1) stk.push_back(n1);
+      continue;
+    }
+    stk.pop_back();
+
+    // Fresh var for this AND gate and its Tseitin clauses
+    int v = S.newVar();
+    node2var[n] = v;
+    Glucose::Lit lit_v = Glucose::mkLit(v);
+    Glucose::Lit a = toLit(aig.getFanin0(n));
+    Glucose::Lit b = toLit(aig.getFanin1(n));
+    S.addClause(~lit_v, a);
+    S.addClause(~lit_v, b);
+    S.addClause(lit_v, ~a, ~b);
+  }
+  return toLit(root);
+}
+
+}  // namespace KEPLER_FORMAL
@@ -0,0 +1,29 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <vector>
+#include "AIG.h"
+
+// include Glucose headers (adjust path to your checkout)
+#include "core/SolverTypes.h"
+#include "simp/SimpSolver.h"
+
+namespace KEPLER_FORMAL {
+
+//
+// A tiny Tseitin-translator from AIG -> Glucose CNF.
+//
+// Returns the Glucose::Lit that stands for `root`, and adds all necessary
+// clauses to S so that Lit <-> (root) holds.
+//
+// node2var   solver variable of each AIG node, -1 while not encoded. Inputs
+//            are AIG nodes keyed by var id, so both designs share them.
+//
+Glucose::Lit tseitinEncode(Glucose::SimpSolver& S,
+                           const AIG& aig,
+                           AIG::Lit root,
+                           std::vector<int>& node2var);
+
+}  // namespace KEPLER_FORMAL
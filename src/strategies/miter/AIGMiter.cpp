@@ -0,0 +1,317 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "AIGMiter.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <numeric>
+#include <unordered_map>
+
+namespace KEPLER_FORMAL {
+
+namespace {
+
+// Ternary simulation values; 0 and 1 are the Boolean ones
+constexpr uint8_t kUnknown = 2;
+
+// Nodes of the cone of root in topological order, constant excluded
+std::vector<uint32_t> collectCone(const AIG& aig, AIG::Lit root) {
+  std::vector<uint32_t> cone;
+  std::vector<char> seen(aig.getNumNodes(), 0);
+  std::vector<uint32_t> stack{AIG::getNode(root)};
+  while (!stack.empty()) {
+    const uint32_t node = stack.back();
+    stack.pop_back();
+    if (node == 0 || seen[node]) continue;
+    seen[node] = 1;
+    cone.push_back(node);
+    if (aig.isAnd(node)) {
+      stack.push_back(AIG::getNode(aig.getFanin0(node)));
+      stack.push_back(AIG::getNode(aig.getFanin1(node)));
+    }
+  }
+  std::sort(cone.begin(), cone.end());
+  return cone;
+}
+
+uint8_t getValue(const std::vector<uint8_t>& values, AIG::Lit lit) {
+  const uint8_t value = values[AIG::getNode(lit)];
+  return value == kUnknown ? kUnknown : value ^ AIG::isComplemented(lit);
+}
+
+// Simulates the and nodes of cone; input values are set by the caller
+void simulateCone(const AIG& aig,
+                  const std::vector<uint32_t>& cone,
+                  std::vector<uint8_t>& values) {
+  for (uint32_t node : cone) {
+    if (!aig.isAnd(node)) continue;
+    const uint8_t a = getValue(values, aig.getFanin0(node));
+    const uint8_t b = getValue(values, aig.getFanin1(node));
+    values[node] = (a == 0 || b == 0)   ? 0
+                   : (a == 1 && b == 1) ? 1
+                                        : kUnknown;
+  }
+}
+
+}  // namespace
+
+std::vector<std::vector<size_t>> clusterBySupport(
+    const AIG& aig,
+    const std::vector<AIG::Lit>& roots) {
+  constexpr size_t kNoRoot = SIZE_MAX;
+  std::vector<size_t> parent(roots.size());
+  std::iota(parent.begin(), parent.end(), 0);
+  auto find = [&](size_t r) {
+    while (parent[r] != r) {
+      parent[r] = parent[parent[r]];
+      r = parent[r];
+    }
+    return r;
+  };
+
+  // Every node belongs to the first root reaching it; a later root hitting
+  // an owned node joins the owner's cluster and does not descend further,
+  // the cone below being owned already.
+  std::vector<size_t> owner(aig.getNumNodes(), kNoRoot);
+  std::vector<uint32_t> stack;
+  for (size_t r = 0; r < roots.size(); ++r) {
+    if (roots[r] == AIG::kFalse) continue;
+    stack.push_back(AIG::getNode(roots[r]));
+    while (!stack.empty()) {
+      const uint32_t node = stack.back();
+      stack.pop_back();
+      // the constant node is no support
+      if (node == 0) continue;
+      if (owner[node] != kNoRoot) {
+        const size_t a = find(owner[node]);
+        const size_t b = find(r);
+        if (a != b) {
+          parent[std::max(a, b)] = std::min(a, b);
+        }
+        continue;
+      }
+      owner[node] = r;
+      if (aig.isAnd(node)) {
+        stack.push_back(AIG::getNode(aig.getFanin0(node)));
+        stack.push_back(AIG::getNode(aig.getFanin1(node)));
+      }
+    }
+  }
+
+  // Union by smallest index: a cluster's representative is its first root
+  std::vector<size_t> clusterOf(roots.size(), kNoRoot);
+  std::vector<std::vector<size_t>> clusters;
+  for (size_t r = 0; r < roots.size(); ++r) {
+    if (roots[r] == AIG::kFalse) continue;
+    const size_t rep = find(r);
+    if (clusterOf[rep] == kNoRoot) {
+      clusterOf[rep] = clusters.size();
+      clusters.emplace_back();
+    }
+    clusters[clusterOf[rep]].push_back(r);
+  }
+  return clusters;
+}
+
+std::vector<std::vector<size_t>> partitionBySupport(
+    const AIG& aig,
+    const std::vector<AIG::Lit>& roots,
+    size_t maxSupport) {
+  std::vector<std::vector<size_t>> clusters = clusterBySupport(aig, roots);
+  if (maxSupport == 0) {
+    return clusters;
+  }
+
+  // Input nodes of the cone of each root of a cluster, in visit order
+  std::vector<uint32_t> stamp(aig.getNumNodes(), 0);
+  uint32_t visit = 0;
+  auto getSupport = [&](AIG::Lit root) {
+    std::vector<uint32_t> support;
+    std::vector<uint32_t> stack{AIG::getNode(root)};
+    ++visit;
+    while (!stack.empty()) {
+      const uint32_t node = stack.back();
+      stack.pop_back();
+      if (node == 0 || stamp[node] == visit) continue;
+      stamp[node] = visit;
+      if (aig.isAnd(node)) {
+        stack.push_back(AIG::getNode(aig.getFanin0(node)));
+        stack.push_back(AIG::getNode(aig.getFanin1(node)));
+      } else {
+        support.push_back(node);
+      }
+    }
+    return support;
+  };
+
+  std::vector<std::vector<size_t>> parts;
+  for (auto& cluster : clusters) {
+    std::vector<std::vector<uint32_t>> supports;
+    supports.reserve(cluster.size());
+    for (size_t r : cluster) {
+      supports.push_back(getSupport(roots[r]));
+    }
+    // size of the union of the supports
+    size_t clusterSupport = 0;
+    ++visit;
+    for (const auto& support : supports) {
+      for (uint32_t input : support) {
+        if (stamp[input] != visit) {
+          stamp[input] = visit;
+          ++clusterSupport;
+        }
+      }
+    }
+    if (clusterSupport <= maxSupport) {
+      parts.push_back(std::move(cluster));
+      continue;
+    }
+
+    // Greedy split: inputs are indexed by the parts reading them, so the
+    // overlap of a root with every part is counted in one pass over its
+    // support
+    const size_t firstPart = parts.size();
+    std::vector<size_t> partSupports;
+    std::unordered_map<uint32_t, std::vector<size_t>> input2parts;
+    std::unordered_map<size_t, size_t> overlaps;
+    for (size_t k = 0; k < cluster.size(); ++k) {
+      const auto& support = supports[k];
+      overlaps.clear();
+      for (uint32_t input : support) {
+        auto it = input2parts.find(input);
+        if (it == input2parts.end()) continue;
+        for (size_t p : it->second) {
+          ++overlaps[p];
+        }
+      }
+      size_t best = SIZE_MAX;
+      size_t bestOverlap = 0;
+      for (const auto& [p, overlap] : overlaps) {
+        const size_t merged = partSupports[p] + support.size() - overlap;
+        if (merged <= maxSupport &&
+            (overlap > bestOverlap || (overlap == bestOverlap && p < best))) {
+          best = p;
+          bestOverlap = overlap;
+        }
+      }
+      if (best == SIZE_MAX) {
+        // no part it shares inputs with has room: fill any part that has
+        for (size_t p = 0; p < partSupports.size() && best == SIZE_MAX; ++p) {
+          if (partSupports[p] + support.size() <= maxSupport) {
+            best = p;
+          }
+        }
+      }
+      if (best == SIZE_MAX) {
+        best = partSupports.size();
+        partSupports.push_back(0);
+        parts.emplace_back();
+      }
+      parts[firstPart + best].push_back(cluster[k]);
+      partSupports[best] += support.size() - bestOverlap;
+      for (uint32_t input : support) {
+        auto& readers = input2parts[input];
+        if (std::find(readers.begin(), readers.end(), best) == readers.end()) {
+          readers.push_back(best);
+        }
+      }
+    }
+  }
+  // Parts of a cluster start in root order but may interleave with each other
+  std::sort(parts.begin(), parts.end(),
+            [](const auto& a, const auto& b) { return a[0] < b[0]; });
+  return parts;
+}
+
+AIG extractCones(const AIG& aig,
+                 std::vector<AIG::Lit>& roots,
+                 std::vector<AIG::Lit>& map) {
+  // Collect the cone; kFalse marks a node seen but not copied yet
+  std::vector<uint32_t> cone;
+  std::vector<uint32_t> stack;
+  for (AIG::Lit root : roots) {
+    stack.push_back(AIG::getNode(root));
+  }
+  while (!stack.empty()) {
+    const uint32_t node = stack.back();
+    stack.pop_back();
+    if (node == 0 || map[node] != AIG::kNoLit) continue;
+    map[node] = AIG::kFalse;
+    cone.push_back(node);
+    if (aig.isAnd(node)) {
+      stack.push_back(AIG::getNode(aig.getFanin0(node)));
+      stack.push_back(AIG::getNode(aig.getFanin1(node)));
+    }
+  }
+  // Node ids are topological
+  std::sort(cone.begin(), cone.end());
+
+  AIG sub;
+  map[0] = AIG::kFalse;
+  for (uint32_t node : cone) {
+    if (aig.isInput(node)) {
+      map[node] = sub.createInput(aig.getInputVarId(node));
+    } else {
+      map[node] = sub.createAnd(AIG::remapLit(map, aig.getFanin0(node)),
+                                AIG::remapLit(map, aig.getFanin1(node)));
+    }
+  }
+  for (AIG::Lit& root : roots) {
+    root = AIG::remapLit(map, root);
+  }
+  for (uint32_t node : cone) {
+    map[node] = AIG::kNoLit;
+  }
+  map[0] = AIG::kNoLit;
+  return sub;
+}
+
+bool evaluateCube(const AIG& aig, AIG::Lit lit, const InputCube& cube) {
+  std::unordered_map<size_t, bool> assignment(cube.begin(), cube.end());
+  const std::vector<uint32_t> cone = collectCone(aig, lit);
+  std::vector<uint8_t> values(aig.getNumNodes(), 0);
+  for (uint32_t node : cone) {
+    if (aig.isInput(node)) {
+      auto it = assignment.find(aig.getInputVarId(node));
+      values[node] = it != assignment.end() && it->second;
+    }
+  }
+  simulateCone(aig, cone, values);
+  return getValue(values, lit) == 1;
+}
+
+void minimizeCube(const AIG& aig, AIG::Lit lit, InputCube& cube) {
+  const std::vector<uint32_t> cone = collectCone(aig, lit);
+  std::unordered_map<size_t, uint32_t> var2node;
+  for (uint32_t node : cone) {
+    if (aig.isInput(node)) {
+      var2node[aig.getInputVarId(node)] = node;
+    }
+  }
+  std::vector<uint8_t> values(aig.getNumNodes(), kUnknown);
+  values[0] = 0;
+  InputCube inCone;
+  for (const auto& [varId, value] : cube) {
+    auto it = var2node.find(varId);
+    if (it == var2node.end()) continue;
+    values[it->second] = value;
+    inCone.emplace_back(varId, value);
+  }
+  simulateCone(aig, cone, values);
+  assert(getValue(values, lit) == 1);
+
+  // Greedy: each input is tried once, in cube order
+  cube.clear();
+  for (const auto& [varId, value] : inCone) {
+    const uint32_t node = var2node.at(varId);
+    values[node] = kUnknown;
+    simulateCone(aig, cone, values);
+    if (getValue(values, lit) != 1) {
+      values[node] = value;
+      cube.emplace_back(varId, value);
+    }
+  }
+}
+
+}  // namespace KEPLER_FORMAL
@@ -0,0 +1,49 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <utility>
+#include <vector>
+#include "AIG.h"
+
+namespace KEPLER_FORMAL {
+
+// Groups the roots whose cones share a node (hence an input), transitively.
+// Each cluster lists root indices in ascending order and clusters are sorted
+// by their first root. kFalse roots belong to no cluster.
+std::vector<std::vector<size_t>> clusterBySupport(
+    const AIG& aig,
+    const std::vector<AIG::Lit>& roots);
+
+// clusterBySupport() with every cluster reading more than maxSupport inputs
+// split further: its roots are taken in order and each joins the part it
+// shares the most inputs with, as long as that part's support stays within
+// maxSupport, else opens a new part. Parts may share inputs and logic; a root
+// reading more than maxSupport inputs on its own gets a part of its own.
+// Same ordering as clusterBySupport(); maxSupport 0 splits nothing.
+std::vector<std::vector<size_t>> partitionBySupport(
+    const AIG& aig,
+    const std::vector<AIG::Lit>& roots,
+    size_t maxSupport);
+
+// Copies the cones of `roots` into a new AIG and rewrites the roots into it.
+// map is scratch space of aig.getNumNodes() kNoLit entries, left that way on
+// return so it can be reused for the next extraction.
+AIG extractCones(const AIG& aig,
+                 std::vector<AIG::Lit>& roots,
+                 std::vector<AIG::Lit>& map);
+
+// Input assignment as (var id, value) pairs
+using InputCube = std::vector<std::pair<size_t, bool>>;
+
+// Value of `lit` with the inputs of cube set and every other input 0.
+bool evaluateCube(const AIG& aig, AIG::Lit lit, const InputCube& cube);
+
+// Shrinks cube, which must set every input of the cone of `lit` and make it
+// 1, to inputs that force lit to 1 on their own: an input is dropped when
+// ternary simulation with it unknown still yields 1. Inputs outside the cone
+// are dropped as well.
+void minimizeCube(const AIG& aig, AIG::Lit lit, InputCube& cube);
+
+}  // namespace KEPLER_FORMAL
@@ -0,0 +1,227 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "AIGSweeper.h"
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include "AIGCnf.h"
+#include "BoolExprSimulator.h"
+#include "SolveBudget.h"
+
+#include "core/SolverTypes.h"
+#include "simp/SimpSolver.h"
+
+using namespace KEPLER_FORMAL;
+
+namespace {
+
+// Random words simulated before the first proof
+constexpr size_t kInitialWords = 4;
+
+// Counterexamples gathered before they are simulated and the classes split
+constexpr size_t kPatternsPerWord = 64;
+
+uint64_t mix(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+using SplitKey = std::pair<uint32_t, uint64_t>;  // class, normalized word
+
+struct SplitKeyHash {
+  size_t operator()(const SplitKey& key) const {
+    return mix(key.second ^ mix(key.first));
+  }
+};
+
+}  // namespace
+
+void AIGSweeper::simulateWord(const std::vector<uint64_t>& inputWords) {
+  auto faninWord = [&](AIG::Lit lit) {
+    const uint64_t value = word_[pos_[AIG::getNode(lit)]];
+    return AIG::isComplemented(lit) ? ~value : value;
+  };
+  for (size_t i = 0; i < cone_.size(); ++i) {
+    const uint32_t node = cone_[i];
+    if (aig_.isInput(node)) {
+      word_[i] = inputWords[i];
+    } else if (aig_.isAnd(node)) {
+      word_[i] = faninWord(aig_.getFanin0(node)) &
+                 faninWord(aig_.getFanin1(node));
+    } else {
+      word_[i] = 0;
+    }
+  }
+  if (numWords_++ == 0) {
+    // signatures are compared up to complement: the first bit fixes the phase
+    for (size_t i = 0; i < cone_.size(); ++i) {
+      phase_[i] = word_[i] & 1;
+    }
+  }
+}
+
+void AIGSweeper::refineClasses() {
+  // Members matching the earliest one of their class stay in it, the others
+  // move to one new class per (class, value)
+  std::unordered_map<SplitKey, uint32_t, SplitKeyHash> splits;
+  for (size_t i = 0; i < cone_.size(); ++i) {
+    const uint32_t c = class_[i];
+    if (c == kNoClass || size_[c] == 1) continue;
+    const uint64_t value = getNormalizedWord(i);
+    if (value == getNormalizedWord(first_[c])) continue;
+    auto [it, inserted] = splits.try_emplace(
+        SplitKey{c, value}, static_cast<uint32_t>(first_.size()));
+    if (inserted) {
+      first_.push_back(i);
+      size_.push_back(0);
+    }
+    class_[i] = it->second;
+    --size_[c];
+    ++size_[it->second];
+  }
+}
+
+AIG AIGSweeper::sweep(std::vector<AIG::Lit>& roots) {
+  const size_t numNodes = aig_.getNumNodes();
+
+  // Cone of the roots, kept in the topological order of the node array
+  std::vector<char> inCone(numNodes, 0);
+  inCone[0] = 1;
+  std::vector<uint32_t> stack;
+  for (AIG::Lit root : roots) {
+    stack.push_back(AIG::getNode(root));
+  }
+  while (!stack.empty()) {
+    const uint32_t node = stack.back();
+    stack.pop_back();
+    if (inCone[node]) continue;
+    inCone[node] = 1;
+    if (aig_.isAnd(node)) {
+      stack.push_back(AIG::getNode(aig_.getFanin0(node)));
+      stack.push_back(AIG::getNode(aig_.getFanin1(node)));
+    }
+  }
+  cone_.clear();
+  pos_.assign(numNodes, kNoNode);
+  std::vector<size_t> inputPositions;
+  for (uint32_t node = 0; node < numNodes; ++node) {
+    if (!inCone[node]) continue;
+    pos_[node] = cone_.size();
+    if (aig_.isInput(node)) {
+      inputPositions.push_back(cone_.size());
+    }
+    cone_.push_back(node);
+  }
+
+  // Same stimulus per var id as the output simulation
+  auto randomInputWord = [&](size_t position, size_t word) {
+    return BoolExprSimulator::inputWord(BoolExprSimulator::kDefaultSeed,
+                                        aig_.getInputVarId(cone_[position]),
+                                        word);
+  };
+  // Every node starts in one class, split by each simulated word
+  word_.assign(cone_.size(), 0);
+  phase_.assign(cone_.size(), 0);
+  numWords_ = 0;
+  class_.assign(cone_.size(), 0);
+  first_.assign(1, 0);
+  size_.assign(1, cone_.size());
+  std::vector<uint64_t> inputWords(cone_.size(), 0);
+  for (size_t w = 0; w < kInitialWords; ++w) {
+    for (size_t i : inputPositions) {
+      inputWords[i] = randomInputWord(i, w);
+    }
+    simulateWord(inputWords);
+    refineClasses();
+  }
+
+  repr_.assign(numNodes, AIG::kNoLit);
+  Glucose::SimpSolver solver;
+  std::vector<int> node2var;
+  Glucose::vec<Glucose::Lit> assumps;
+  std::fill(inputWords.begin(), inputWords.end(), 0);
+  size_t numPatterns = 0;
+  for (size_t i = 0; i < cone_.size(); ++i) {
+    const uint32_t node = cone_[i];
+    // the earliest node of the class is the candidate of the later ones
+    const uint32_t first = first_[class_[i]];
+    if (!aig_.isAnd(node) || first == i) continue;
+    if (budget_ != nullptr && budget_->isExhausted()) {
+      ++numUndecided_;
+      continue;
+    }
+    const uint32_t candidate = cone_[first];
+    const bool phase = phase_[i] != phase_[first];
+    // Variable elimination stays off: the solver is queried on any node
+    const Glucose::Lit a =
+        tseitinEncode(solver, aig_, AIG::makeLit(node), node2var);
+    const Glucose::Lit b =
+        tseitinEncode(solver, aig_, AIG::makeLit(candidate, phase), node2var);
+    Glucose::lbool result = l_False;
+    for (int side = 0; side < 2 && result == l_False; ++side) {
+      assumps.clear();
+      assumps.push(side == 0 ? a : ~a);
+      assumps.push(side == 0 ? ~b : b);
+      if (budget_ != nullptr) {
+        result = budget_->solve(solver, assumps, false, 0, conflictBudget_);
+      } else {
+        if (conflictBudget_ >= 0) {
+          solver.setConfBudget(conflictBudget_);
+        } else {
+          solver.budgetOff();
+        }
+        result = solver.solveLimited(assumps, false);
+      }
+    }
+    if (result == l_False) {
+      repr_[node] = AIG::makeLit(candidate, phase);
+      solver.addClause(~a, b);
+      solver.addClause(a, ~b);
+      --size_[class_[i]];
+      class_[i] = kNoClass;
+      ++numProved_;
+      continue;
+    }
+    if (result == l_Undef) {
+      ++numUndecided_;
+      continue;
+    }
+    ++numDisproved_;
+    // Inputs outside the encoded cones are free: keep them random
+    for (size_t j : inputPositions) {
+      const int var = node2var[cone_[j]];
+      const bool value =
+          var != -1 ? solver.modelValue(var) == l_True
+                    : (randomInputWord(j, numWords_) >> numPatterns) & 1;
+      inputWords[j] |= uint64_t{value} << numPatterns;
+    }
+    if (++numPatterns == kPatternsPerWord) {
+      simulateWord(inputWords);
+      std::fill(inputWords.begin(), inputWords.end(), 0);
+      numPatterns = 0;
+      refineClasses();
+    }
+  }
+
+  // Rebuild the cones with every proven node replaced by its representative
+  AIG swept;
+  std::vector<AIG::Lit> map(numNodes, AIG::kNoLit);
+  map[0] = AIG::kFalse;
+  for (uint32_t node : cone_) {
+    if (aig_.isInput(node)) {
+      map[node] = swept.createInput(aig_.getInputVarId(node));
+    } else if (repr_[node] != AIG::kNoLit) {
+      map[node] = AIG::remapLit(map, repr_[node]);
+    } else if (aig_.isAnd(node)) {
+      map[node] = swept.createAnd(AIG::remapLit(map, aig_.getFanin0(node)),
+                                  AIG::remapLit(map, aig_.getFanin1(node)));
+    }
+  }
+  for (AIG::Lit& root : roots) {
+    root = AIG::remapLit(map, root);
+  }
+  return swept;
+}
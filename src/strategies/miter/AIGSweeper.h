@@ -0,0 +1,80 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "AIG.h"
+
+namespace KEPLER_FORMAL {
+
+class SolveBudget;
+
+/// SAT sweeping (fraiging) of an AIG.
+///
+/// Nodes of the swept cones are simulated on random patterns; a node whose
+/// signature equals (or complements) the one of an earlier node is a
+/// candidate equivalence. Candidates are proved in topological order on one
+/// incremental solver, each proven pair being added back as an equality so
+/// later proofs get cheaper. Counterexamples are collected into extra
+/// simulation words that split the candidate classes in place; only the
+/// word being simulated is kept.
+///
+/// Run on the AIG holding both designs of a miter, the internal points the
+/// two designs have in common collapse to single nodes and the output
+/// miters shrink to the logic that actually differs.
+class AIGSweeper {
+ public:
+  explicit AIGSweeper(const AIG& aig) : aig_(aig) {}
+
+  /// Conflicts allowed per equivalence check, negative for no limit.
+  /// Checks out of budget leave the pair unmerged.
+  void setConflictBudget(int64_t budget) { conflictBudget_ = budget; }
+  /// Checks also run within the limits of `budget` (propagations, time),
+  /// the conflict budget above tightening its conflict limit; once its total
+  /// time is spent the remaining candidates are left unmerged.
+  void setSolveBudget(const SolveBudget* budget) { budget_ = budget; }
+
+  /// Returns the swept graph holding the cones of `roots`; the roots are
+  /// rewritten in place into it.
+  AIG sweep(std::vector<AIG::Lit>& roots);
+
+  size_t getNumProved() const { return numProved_; }
+  size_t getNumDisproved() const { return numDisproved_; }
+  size_t getNumUndecided() const { return numUndecided_; }
+
+ private:
+  static constexpr uint32_t kNoNode = UINT32_MAX;
+  static constexpr uint32_t kNoClass = UINT32_MAX;
+
+  // Simulates one more word over the cone into word_; inputWords holds the
+  // values of the input nodes, by cone position
+  void simulateWord(const std::vector<uint64_t>& inputWords);
+  // Value of word_ at cone position `pos`, complemented for odd phases
+  uint64_t getNormalizedWord(size_t pos) const {
+    return phase_[pos] ? ~word_[pos] : word_[pos];
+  }
+  // Splits the classes whose members word_ tells apart
+  void refineClasses();
+
+  const AIG& aig_;
+  int64_t conflictBudget_ = 1000;
+  const SolveBudget* budget_ = nullptr;
+  std::vector<uint32_t> cone_;  // nodes of the swept cones, topological
+  std::vector<uint32_t> pos_;   // cone position of each node
+  std::vector<uint64_t> word_;  // last simulated word, by cone position
+  std::vector<char> phase_;     // first simulated bit, by cone position
+  size_t numWords_ = 0;
+  std::vector<AIG::Lit> repr_;  // proven equivalent literal, kNoLit if none
+  // Candidate classes: class of each cone position (kNoClass once merged),
+  // earliest position and size of each class
+  std::vector<uint32_t> class_;
+  std::vector<uint32_t> first_;
+  std::vector<uint32_t> size_;
+  size_t numProved_ = 0;
+  size_t numDisproved_ = 0;
+  size_t numUndecided_ = 0;
+};
+
+}  // namespace KEPLER_FORMAL
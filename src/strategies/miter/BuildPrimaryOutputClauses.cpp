@@ -2,11 +2,18 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
 #include "BuildPrimaryOutputClauses.h"
+#include "BoolExprCache.h"
+#include "Concurrency.h"
 #include "DNL.h"
+#include "PerfReport.h"
 #include "SNLDesignModeling.h"
 #include "SNLLogicCloud.h"
+#include "SNLLogicDAG.h"
 #include "Tree2BoolExpr.h"
 #include "SNLPath.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 
 // #define DEBUG_PRINTS
 // #define DEBUG_CHECKS
@@ -372,13 +379,15 @@ void BuildPrimaryOutputClauses::collect() {
   POs_.resize(outputs_.size());
 }
 
-void BuildPrimaryOutputClauses::initVarNames() {
-  termDNLID2varID_.resize(naja::DNL::get()->getDNLTerms().size(), (size_t)-1);
+void BuildPrimaryOutputClauses::initVarNames(const DNLFull& dnl) {
+  termDNLID2varID_.resize(dnl.getDNLTerms().size(), (size_t)-1);
+  // isTopPort() resolves through the current DNL, which dnl need not be
+  const auto topTerms = dnl.getTop().getTermIndexes();
   for (size_t i = 0; i < inputs_.size(); ++i) {
     // Get Truth Table for terminal
-    const DNLTerminalFull& tTerm = naja::DNL::get()->getDNLTerminalFromID(inputs_[i]);
+    const DNLTerminalFull& tTerm = dnl.getDNLTerminalFromID(inputs_[i]);
     // If direction is input, skip
-    if (!tTerm.isTopPort()) {
+    if (inputs_[i] < topTerms.first || inputs_[i] > topTerms.second) {
       const auto& tt = SNLDesignModeling::getTruthTable(tTerm.getSnlBitTerm()->getDesign(), 
       tTerm.getSnlBitTerm()->getOrderID());
       if (tt.isInitialized()) {
@@ -397,10 +406,48 @@ void BuildPrimaryOutputClauses::initVarNames() {
 }
 
 void BuildPrimaryOutputClauses::build() {
-  naja::DNL::get();
+  // the truth-table trees of the BoolExpr mode only read the current DNL
+  assert(dnl_ == nullptr || buildAIG_);
+  const DNLFull& dnl = dnl_ != nullptr ? *dnl_ : *naja::DNL::get();
   POs_.clear();
   POs_ = tbb::concurrent_vector<std::shared_ptr<BoolExpr>>(outputs_.size());
-  initVarNames();
+  POLits_.assign(outputs_.size(), AIG::kNoLit);
+  initVarNames(dnl);
+  PerfReport::Phase phase("cone_build");
+  phase.add("outputs", outputs_.size());
+  if (buildAIG_) {
+    // AIG mode: one netlist-wide DAG, every PO is a literal into it and each
+    // driver is expanded once whatever the number of cones it belongs to
+    aig_ = AIG();
+    SNLLogicDAG dag(dnl, inputs_, outputs_, termDNLID2varID_, aig_);
+    // Inputs hash by name so cone hashes survive edits elsewhere in the design
+    std::vector<uint64_t> inputHashes(termDNLID2varID_.size(), 0);
+    if (!inputHashes_.empty()) {
+      for (size_t i = 0; i < inputs_.size() && i < inputHashes_.size(); ++i) {
+        inputHashes[inputs_[i]] = inputHashes_[i];
+      }
+    } else {
+      for (const auto& [input, path] : inputs2inputsIDs_) {
+        inputHashes[input] = getPathHash(path);
+      }
+    }
+    if (!inputHashes_.empty() || !inputs2inputsIDs_.empty()) {
+      dag.setInputHashes(inputHashes);
+    }
+    POConeHashes_.assign(outputs_.size(), 0);
+    for (size_t i = 0; i < outputs_.size(); ++i) {
+      POLits_[i] = dag.getOutputLit(outputs_[i], &POConeHashes_[i]);
+    }
+    DEBUG_LOG("Logic DAG: %zu drivers expanded, %zu AIG nodes\n",
+              dag.getNumExpandedDrivers(), aig_.getNumNodes());
+    phase.add("expanded_drivers", dag.getNumExpandedDrivers())
+        .add("strashed_drivers", dag.getNumStrashedDrivers())
+        .add("and_nodes", aig_.getNumAnds());
+    if (releaseDNL_) {
+      destroy();  // Clean up DNL instance
+    }
+    return;
+  }
   // Init var names(counting on the fact that normalization happened before)
 
   // inputs_ = collectInputs();
@@ -408,9 +455,9 @@ void BuildPrimaryOutputClauses::build() {
   // outputs_ = collectOutputs();
   // sortOutputs();
   size_t processedOutputs = 0;
-  // tbb::task_arena arena(20);
-  //  init arena with automatic number of threads
-  tbb::task_arena arena(40);
+  // Conversion time summed over the workers, only measured when reported
+  const bool timed = PerfReport::isEnabled();
+  std::atomic<int64_t> convertNanoseconds{0};
   auto processOutput = [&](size_t i) {
     DNLID out = outputs_[i];
     DEBUG_LOG("Procssing output %zu/%zu: %s\n", ++processedOutputs,
@@ -498,13 +545,20 @@ void BuildPrimaryOutputClauses::build() {
     //  }
     assert(POs_.size() - 1 >= i);
     cloud.getTruthTable().finalize();
+    const auto convertStart = timed ? std::chrono::steady_clock::now()
+                                    : std::chrono::steady_clock::time_point();
     POs_[i] = Tree2BoolExpr::convert(cloud.getTruthTable(), termDNLID2varID_);
+    if (timed) {
+      convertNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now() - convertStart)
+                                .count();
+    }
     cloud.destroy();
     // BoolExpr::getMutex().unlock();
     // printf("size of expr: %lu\n", POs_.back()->size());
   };
 
-  if (getenv("KEPLER_NO_MT")) {
+  if (!Concurrency::isParallel()) {
     for (size_t i = 0; i < outputs_.size(); ++i) {
       processOutput(i);
     }
@@ -516,7 +570,52 @@ void BuildPrimaryOutputClauses::build() {
                         }
                       });
   }
-  destroy();  // Clean up DNL instance
+  phase.add("boolexpr_convert_thread_seconds", convertNanoseconds * 1e-9)
+      .add("boolexpr_cache_queries", BoolExprCache::getNumQueries())
+      .add("boolexpr_cache_hits", BoolExprCache::getNumHits())
+      .add("boolexpr_cache_front_hits", BoolExprCache::getNumFrontHits())
+      .add("boolexpr_cache_entries", BoolExprCache::getNumEntries())
+      .add("boolexpr_cache_reclaimed", BoolExprCache::getNumReclaimed());
+  if (releaseDNL_) {
+    destroy();  // Clean up DNL instance
+  }
+}
+
+uint64_t BuildPrimaryOutputClauses::getPathHash(
+    const std::pair<std::vector<NLName>, std::vector<NLID::DesignObjectID>>&
+        path) {
+  // FNV-1a over the names then the ids, with separators between fields
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  auto addByte = [&hash](unsigned char c) {
+    hash ^= c;
+    hash *= 0x100000001b3ULL;
+  };
+  for (const auto& name : path.first) {
+    for (char c : name.getString()) addByte(static_cast<unsigned char>(c));
+    addByte(0);
+  }
+  addByte(1);
+  for (auto id : path.second) {
+    for (size_t b = 0; b < sizeof(id); ++b) addByte((id >> (8 * b)) & 0xff);
+  }
+  return hash;
+}
+
+std::vector<uint64_t> BuildPrimaryOutputClauses::getPairedInputHashes(
+    const std::vector<std::pair<std::vector<NLName>,
+                                std::vector<NLID::DesignObjectID>>>& paths0,
+    const std::vector<std::pair<std::vector<NLName>,
+                                std::vector<NLID::DesignObjectID>>>& paths1) {
+  std::vector<uint64_t> hashes(std::max(paths0.size(), paths1.size()));
+  for (size_t i = 0; i < hashes.size(); ++i) {
+    const uint64_t hash0 = i < paths0.size() ? getPathHash(paths0[i]) : 0;
+    const uint64_t hash1 = i < paths1.size() ? getPathHash(paths1[i]) : 0;
+    // ordered combination: (a, b) and (b, a) are different pairings
+    uint64_t x = hash0 * 0x9e3779b97f4a7c15ULL;
+    x ^= hash1 + 0x9e3779b97f4a7c15ULL + (x << 6) + (x >> 2);
+    hashes[i] = x ^ (x >> 31);
+  }
+  return hashes;
 }
 
 void BuildPrimaryOutputClauses::setInputs2InputsIDs() {
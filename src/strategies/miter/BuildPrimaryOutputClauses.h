@@ -3,6 +3,7 @@
 
 #include <tbb/concurrent_vector.h>
 #include <vector>
+#include "AIG.h"
 #include "BoolExpr.h"
 #include "DNL.h"
 
@@ -19,7 +20,39 @@ class BuildPrimaryOutputClauses {
   const tbb::concurrent_vector<std::shared_ptr<BoolExpr>>& getPOs() const {
     return POs_;
   }
+  // When set, build() emits the POs into one netlist-wide AIG (SNLLogicDAG,
+  // each driver expanded once) instead of per-output BoolExpr cones.
+  void setBuildAIG(bool buildAIG) { buildAIG_ = buildAIG; }
+  // build() destroys the DNL when done unless its owner keeps it (DNLSwitcher)
+  void setReleaseDNL(bool releaseDNL) { releaseDNL_ = releaseDNL; }
+  // AIG mode: DNL read by build() instead of the current one (a copy from
+  // DNLSwitcher::copy), so two designs can be built concurrently
+  void setDNL(const naja::DNL::DNLFull* dnl) { dnl_ = dnl; }
+  AIG& getAIG() { return aig_; }
+  const std::vector<AIG::Lit>& getPOLits() const { return POLits_; }
+  // AIG mode only: structural hash of each PO cone, see SNLLogicDAG
+  const std::vector<uint64_t>& getPOConeHashes() const { return POConeHashes_; }
+  // Name-based hash of a terminal path (instance path names, term ids)
+  static uint64_t getPathHash(
+      const std::pair<std::vector<NLName>, std::vector<NLID::DesignObjectID>>&
+          path);
+  // Hash of each normalized input (var id - 2) from the paths it has in both
+  // designs, an input missing from one design hashing that side as 0. Inputs
+  // found in one design only are paired by position, so the hash follows the
+  // pairing and not just the path.
+  static std::vector<uint64_t> getPairedInputHashes(
+      const std::vector<std::pair<std::vector<NLName>,
+                                  std::vector<NLID::DesignObjectID>>>& paths0,
+      const std::vector<std::pair<std::vector<NLName>,
+                                  std::vector<NLID::DesignObjectID>>>& paths1);
+  // AIG mode: input hashes of the cone hashes, by normalized input; without
+  // them each input hashes by its own path
+  void setInputHashes(const std::vector<uint64_t>& inputHashes) {
+    inputHashes_ = inputHashes;
+  }
   const std::vector<naja::DNL::DNLID>& getInputs() const { return inputs_; }
+  // Var id of each input terminal (by DNLID) after build(), -1 elsewhere
+  const std::vector<size_t>& getInputVarIDs() const { return termDNLID2varID_; }
   const std::vector<naja::DNL::DNLID>& getOutputs() const { return outputs_; }
   const std::map<naja::DNL::DNLID,
                  std::pair<std::vector<NLName>, std::vector<NLID::DesignObjectID>>>&
@@ -58,9 +91,16 @@ class BuildPrimaryOutputClauses {
   std::vector<naja::DNL::DNLID> collectOutputs();
   void setOutputs2OutputsIDs();
   void sortOutputs();
-  void initVarNames();
+  void initVarNames(const naja::DNL::DNLFull& dnl);
 
   tbb::concurrent_vector<std::shared_ptr<BoolExpr>> POs_;
+  bool buildAIG_ = false;
+  bool releaseDNL_ = true;
+  const naja::DNL::DNLFull* dnl_ = nullptr;
+  AIG aig_;
+  std::vector<AIG::Lit> POLits_;
+  std::vector<uint64_t> POConeHashes_;
+  std::vector<uint64_t> inputHashes_;
   std::vector<naja::DNL::DNLID> inputs_;
   std::vector<naja::DNL::DNLID> outputs_;
   std::map<std::pair<std::vector<NLName>, std::vector<NLID::DesignObjectID>>, naja::DNL::DNLID> inputsMap_;
@@ -0,0 +1,82 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "MiterResultCache.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using namespace KEPLER_FORMAL;
+
+namespace {
+
+constexpr const char* kHeader = "kepler-formal-result-cache 1";
+
+}  // namespace
+
+bool MiterResultCache::load(const std::string& path) {
+  entries_.clear();
+  std::ifstream in(path);
+  if (!in) {
+    return false;
+  }
+  std::string line;
+  if (!std::getline(in, line) || line != kHeader) {
+    return false;
+  }
+  // one output per line: key hash0 hash1 verdict, hashes in hex
+  while (std::getline(in, line)) {
+    if (line.empty()) continue;
+    std::istringstream fields(line);
+    uint64_t key = 0;
+    Entry entry;
+    char verdict = 0;
+    fields >> std::hex >> key >> entry.coneHash0 >> entry.coneHash1 >> verdict;
+    if (fields.fail() ||
+        (verdict != 'E' && verdict != 'D' && verdict != 'U')) {
+      entries_.clear();
+      return false;
+    }
+    entry.verdict = verdict == 'E'   ? Verdict::Equivalent
+                    : verdict == 'D' ? Verdict::Different
+                                     : Verdict::Undecided;
+    entries_[key] = entry;
+  }
+  return true;
+}
+
+bool MiterResultCache::save(const std::string& path) const {
+  const std::string tmpPath = path + ".tmp";
+  {
+    std::ofstream out(tmpPath, std::ios::trunc);
+    if (!out) {
+      return false;
+    }
+    out << kHeader << "\n" << std::hex;
+    for (const auto& [key, entry] : entries_) {
+      out << key << " " << entry.coneHash0 << " " << entry.coneHash1 << " "
+          << (entry.verdict == Verdict::Equivalent  ? 'E'
+              : entry.verdict == Verdict::Different ? 'D'
+                                                    : 'U')
+          << "\n";
+    }
+    if (!out) {
+      return false;
+    }
+  }
+  return std::rename(tmpPath.c_str(), path.c_str()) == 0;
+}
+
+const MiterResultCache::Entry* MiterResultCache::find(
+    uint64_t outputKey) const {
+  auto it = entries_.find(outputKey);
+  return it == entries_.end() ? nullptr : &it->second;
+}
+
+bool MiterResultCache::isKnownEquivalent(uint64_t outputKey,
+                                         uint64_t coneHash0,
+                                         uint64_t coneHash1) const {
+  const Entry* entry = find(outputKey);
+  return entry != nullptr && entry->verdict == Verdict::Equivalent &&
+         entry->coneHash0 == coneHash0 && entry->coneHash1 == coneHash1;
+}
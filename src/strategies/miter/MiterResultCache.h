@@ -0,0 +1,50 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace KEPLER_FORMAL {
+
+/// On-disk cache of per-output verdicts for incremental runs.
+///
+/// Each output, keyed by the hash of its path, records the cone hash it had
+/// in both designs and the verdict obtained for them. A pair whose two cone
+/// hashes are unchanged since an Equivalent verdict does not need SAT again.
+class MiterResultCache {
+ public:
+  // Undecided: the checks ran out of solver limits, the pair is checked again
+  enum class Verdict : uint8_t { Equivalent = 0, Different = 1, Undecided = 2 };
+  struct Entry {
+    uint64_t coneHash0 = 0;
+    uint64_t coneHash1 = 0;
+    Verdict verdict = Verdict::Different;
+  };
+
+  // Reads a cache file; returns false (and leaves the cache empty) when the
+  // file is missing or not a cache of this version
+  bool load(const std::string& path);
+  // Writes through a temporary file renamed over path
+  bool save(const std::string& path) const;
+
+  // Entry recorded for the output, nullptr if none
+  const Entry* find(uint64_t outputKey) const;
+  // True when the output was proven equivalent with these same cone hashes
+  bool isKnownEquivalent(uint64_t outputKey,
+                         uint64_t coneHash0,
+                         uint64_t coneHash1) const;
+  void set(uint64_t outputKey, const Entry& entry) {
+    entries_[outputKey] = entry;
+  }
+  size_t size() const { return entries_.size(); }
+  void clear() { entries_.clear(); }
+
+ private:
+  std::unordered_map<uint64_t, Entry> entries_;
+};
+
+}  // namespace KEPLER_FORMAL
@@ -0,0 +1,59 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "MiterStimulus.h"
+#include <fstream>
+
+using namespace KEPLER_FORMAL;
+
+namespace {
+
+constexpr const char* kHeader = "kepler-formal-stimulus 1";
+constexpr const char* kOutputKeyword = "output ";
+
+}  // namespace
+
+bool MiterStimulus::load(const std::string& path) {
+  vectors_.clear();
+  std::ifstream in(path);
+  if (!in) {
+    return false;
+  }
+  std::string line;
+  if (!std::getline(in, line) || line != kHeader) {
+    return false;
+  }
+  // "output <name>" opens a vector, followed by one "<input> <0|1>" per line
+  const std::string outputKeyword = kOutputKeyword;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    if (line.compare(0, outputKeyword.size(), outputKeyword) == 0) {
+      vectors_.push_back({line.substr(outputKeyword.size()), {}});
+      continue;
+    }
+    const size_t space = line.rfind(' ');
+    const std::string value =
+        space == std::string::npos ? "" : line.substr(space + 1);
+    if (vectors_.empty() || space == 0 || (value != "0" && value != "1")) {
+      vectors_.clear();
+      return false;
+    }
+    vectors_.back().inputs.emplace_back(line.substr(0, space), value == "1");
+  }
+  return true;
+}
+
+bool MiterStimulus::save(const std::string& path) const {
+  std::ofstream out(path, std::ios::trunc);
+  if (!out) {
+    return false;
+  }
+  out << kHeader << "\n";
+  for (const auto& vector : vectors_) {
+    out << kOutputKeyword << vector.output << "\n";
+    for (const auto& [input, value] : vector.inputs) {
+      out << input << " " << (value ? '1' : '0') << "\n";
+    }
+  }
+  return static_cast<bool>(out);
+}
@@ -0,0 +1,37 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace KEPLER_FORMAL {
+
+/// Replayable stimulus file of the outputs found different.
+///
+/// One vector per output: the output name, then the inputs that distinguish
+/// the two designs on it (top ports and sequential/blackbox pins, by their
+/// hierarchical name) and their values. Inputs left out are don't cares.
+class MiterStimulus {
+ public:
+  struct Vector {
+    std::string output;
+    std::vector<std::pair<std::string, bool>> inputs;
+  };
+
+  // Reads a stimulus file; returns false (and leaves the stimulus empty)
+  // when the file is missing or malformed
+  bool load(const std::string& path);
+  bool save(const std::string& path) const;
+
+  void add(Vector vector) { vectors_.push_back(std::move(vector)); }
+  const std::vector<Vector>& getVectors() const { return vectors_; }
+  size_t size() const { return vectors_.size(); }
+
+ private:
+  std::vector<Vector> vectors_;
+};
+
+}  // namespace KEPLER_FORMAL
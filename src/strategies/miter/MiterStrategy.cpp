@@ -2,8 +2,20 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
 #include "MiterStrategy.h"
+#include "AIG.h"
+#include "AIGCnf.h"
+#include "AIGMiter.h"
+#include "AIGSweeper.h"
 #include "BoolExpr.h"
+#include "BoolExprSimulator.h"
 #include "BuildPrimaryOutputClauses.h"
+#include "CompiledTruthTableTree.h"
+#include "Concurrency.h"
+#include "DNLSwitcher.h"
+#include "MiterResultCache.h"
+#include "MiterStimulus.h"
+#include "SolveBudget.h"
+#include "PerfReport.h"
 #include "NLUniverse.h"
 #include "SNLDesignModeling.h"
 #include "SNLLogicCloud.h"
@@ -23,11 +35,30 @@
 #include <cstdlib>
 #include <stack>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <optional>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_invoke.h>
+
 // spdlog
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_sinks.h>  // ensure console sink is available
 #include <spdlog/spdlog.h>
 
+// #define KEPLER_TRACE
+
+// Per-element tracing inside the miter loops. The logger flushes every info
+// line, so it is compiled out unless KEPLER_TRACE is defined.
+#ifdef KEPLER_TRACE
+#define MITER_TRACE(...) logger->info(__VA_ARGS__)
+#else
+#define MITER_TRACE(...)
+#endif
+
 using namespace naja;
 using namespace naja::NL;
 using namespace KEPLER_FORMAL;
@@ -142,141 +173,403 @@ void ensureLoggerInitialized() {
 //   }
 // }
 
-//
-// A tiny Tseitin-translator from BoolExpr -> Glucose CNF.
-//
-// Returns a Glucose::Lit that stands for `e`, and adds
-// all necessary clauses to S so that Lit ↔ (e) holds.
-//
-// node2var      caches each subformula’s fresh variable index.
-// varName2idx   coalesces all inputs of the same name to one var.
-//
-
-Glucose::Lit tseitinEncode(
-    Glucose::SimpSolver& S,
-    std::shared_ptr<BoolExpr> root,
-    std::unordered_map<std::shared_ptr<BoolExpr>, int>& node2var,
-    std::unordered_map<std::string, int>& varName2idx) {
-  ensureLoggerInitialized();
-  logger->debug("Starting Tseitin encode for root expr");
-
-  auto getOrCreateVar = [&](const std::string& key) -> int {
-    auto it = varName2idx.find(key);
-    if (it != varName2idx.end())
-      return it->second;
-    int v = S.newVar();
-    varName2idx[key] = v;
-    logger->trace("Created new var {} for key '{}'", v, key);
-    return v;
-  };
+// Random patterns simulated per output pair, in 64-bit words, before SAT.
+constexpr size_t kSimulationWords = 16;
 
-  auto constLit = [&](bool value) -> Glucose::Lit {
-    const std::string key = value ? "$__CONST_TRUE__" : "$__CONST_FALSE__";
-    int v = getOrCreateVar(key);
-    Glucose::Lit lv = Glucose::mkLit(v);
-    S.addClause(value ? lv : ~lv);
-    logger->trace("Added constant clause for {} as var {}", value, v);
-    return lv;
-  };
+// Minimum number of output pairs handed to one solver of the pool: below
+// that, re-encoding the shared logic costs more than the parallelism gains.
+constexpr size_t kMinPairsPerSolver = 64;
 
-  struct Frame {
-    std::shared_ptr<BoolExpr> expr;
-    bool visited = false;
-    Glucose::Lit leftLit, rightLit;
-  };
+// One solver of a phase: the size of its encoding, its search and its time
+// from creation, encoding included
+struct SolverCall {
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  int vars = 0;
+  int clauses = 0;
+  uint64_t conflicts = 0;
+  uint64_t decisions = 0;
+  uint64_t propagations = 0;
+  double seconds = 0;
 
-  std::stack<Frame> stk;
-  stk.push({root, false, {}, {}});
-  std::unordered_map<std::shared_ptr<BoolExpr>, Glucose::Lit> result;
+  // Takes the size of the CNF of S and the search counters it starts from
+  void encoded(const Glucose::SimpSolver& S) {
+    vars = S.nVars();
+    clauses = S.nClauses();
+    conflicts = S.conflicts;
+    decisions = S.decisions;
+    propagations = S.propagations;
+  }
+};
 
-  while (!stk.empty()) {
-    Frame& fr = stk.top();
-    std::shared_ptr<BoolExpr> e = fr.expr;
+// Search counters summed over the solvers of a phase, and each solver
+struct SolverStats {
+  uint64_t conflicts = 0;
+  uint64_t decisions = 0;
+  uint64_t propagations = 0;
+  std::vector<SolverCall> calls;
 
-    // If already encoded, reuse
-    if (node2var.count(e)) {
-      result[e] = Glucose::mkLit(node2var[e]);
-      stk.pop();
-      continue;
+  // Adds the search S did since `call` was encoded
+  void add(const Glucose::SimpSolver& S, SolverCall call) {
+    call.conflicts = S.conflicts - call.conflicts;
+    call.decisions = S.decisions - call.decisions;
+    call.propagations = S.propagations - call.propagations;
+    call.seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - call.start)
+                       .count();
+    conflicts += call.conflicts;
+    decisions += call.decisions;
+    propagations += call.propagations;
+    calls.push_back(call);
+  }
+  SolverStats& operator+=(const SolverStats& other) {
+    conflicts += other.conflicts;
+    decisions += other.decisions;
+    propagations += other.propagations;
+    calls.insert(calls.end(), other.calls.begin(), other.calls.end());
+    return *this;
+  }
+  void report(PerfReport::Phase& phase) const {
+    phase.add("conflicts", conflicts)
+        .add("decisions", decisions)
+        .add("propagations", propagations);
+    for (const SolverCall& call : calls) {
+      phase.addCall({{"vars", call.vars},
+                     {"clauses", call.clauses},
+                     {"conflicts", call.conflicts},
+                     {"decisions", call.decisions},
+                     {"propagations", call.propagations},
+                     {"seconds", call.seconds}});
     }
+  }
+};
 
-    // Leaf VAR or CONST
-    if (!fr.visited && e->getOp() == Op::VAR) {
-      const std::string& name = e->getName();
-      Glucose::Lit lit;
-      if (name == "0" || name == "false" || name == "False" || name == "FALSE")
-        lit = constLit(false);
-      else if (name == "1" || name == "true" || name == "True" ||
-               name == "TRUE")
-        lit = constLit(true);
-      else {
-        int v = getOrCreateVar(name);
-        lit = Glucose::mkLit(v);
-      }
-      node2var[e] = Glucose::var(lit);
-      result[e] = lit;
-      stk.pop();
-      continue;
+// Per-worker counters, summed once the workers are done
+using SolverStatsETS = tbb::enumerable_thread_specific<SolverStats>;
+SolverStats combine(const SolverStatsETS& stats) {
+  SolverStats sum;
+  for (const SolverStats& local : stats) {
+    sum += local;
+  }
+  return sum;
+}
+
+// Encodes the XOR literals of the output pairs [begin, end) into S and freezes
+// them so they stay usable as assumptions after variable elimination.
+std::vector<Glucose::Lit> encodeOutputPairs(Glucose::SimpSolver& S,
+                                            const AIG& aig,
+                                            const std::vector<AIG::Lit>& diffs,
+                                            size_t begin,
+                                            size_t end,
+                                            std::vector<int>& node2var) {
+  std::vector<Glucose::Lit> diffLits;
+  diffLits.reserve(end - begin);
+  for (size_t i = begin; i < end; ++i) {
+    diffLits.push_back(tseitinEncode(S, aig, diffs[i], node2var));
+    S.setFrozen(Glucose::var(diffLits.back()), true);
+  }
+  return diffLits;
+}
+
+// Scans the last model of S for output pairs of [from, begin + lits.size())
+// that differ and records the ones not seen yet.
+void collectDiffs(const Glucose::SimpSolver& S,
+                  const std::vector<Glucose::Lit>& diffLits,
+                  size_t begin,
+                  size_t from,
+                  std::vector<char>& differs,
+                  tbb::concurrent_vector<naja::DNL::DNLID>& failed) {
+  for (size_t i = from; i < begin + diffLits.size(); ++i) {
+    if (!differs[i] && S.modelValue(diffLits[i - begin]) == l_True) {
+      differs[i] = 1;
+      failed.push_back(i);
     }
+  }
+}
 
-    // First time we see this node, push children
-    if (!fr.visited) {
-      fr.visited = true;
-      if (e->getRight())
-        stk.push({e->getRight(), false, {}, {}});
-      if (e->getLeft())
-        stk.push({e->getLeft(), false, {}, {}});
+// Checks the output pairs [begin, begin + lits.size()) one by one on the
+// incremental solver S, the XOR literal of each pair being its activation
+// assumption. Pairs already in `differs` or strashed to the same literal need
+// no solve call, and pairs proven equal are fed back to S as unit clauses.
+// A check out of budget marks its pair in `undecided`. Variable elimination
+// runs on the first call only, and only when S has not been solved yet
+// (simplified false).
+void checkOutputPairs(Glucose::SimpSolver& S,
+                      const std::vector<Glucose::Lit>& diffLits,
+                      size_t begin,
+                      const std::vector<AIG::Lit>& diffs,
+                      const SolveBudget& budget,
+                      bool simplified,
+                      std::vector<char>& differs,
+                      std::vector<char>& undecided,
+                      tbb::concurrent_vector<naja::DNL::DNLID>& failed) {
+  Glucose::vec<Glucose::Lit> assumps;
+  for (size_t i = begin; i < begin + diffLits.size(); ++i) {
+    if (differs[i] || diffs[i] == AIG::kFalse) {
       continue;
     }
+    assumps.clear();
+    assumps.push(diffLits[i - begin]);
+    const Glucose::lbool result = budget.solve(S, assumps, !simplified);
+    simplified = true;
+    if (result == l_True) {
+      collectDiffs(S, diffLits, begin, i, differs, failed);
+    } else if (result == l_False) {
+      // Proven equal: hand the fact to the solver for the next outputs.
+      S.addClause(~diffLits[i - begin]);
+    } else {
+      undecided[i] = 1;
+    }
+  }
+}
+
+// Solves each cluster miter on its own solver, over a copy of the cluster
+// cones only; clusters are independent and checked in parallel, logic that
+// two clusters share being copied into both. Each worker extracts the copy
+// of the cluster it checks, so only the clusters in flight hold one. A
+// cluster proven equal has its pair XORs set to kFalse, a differing or
+// undecided one has its pairs checked right away on the same solver.
+void checkClusters(const AIG& aig,
+                   const std::vector<AIG::Lit>& miters,
+                   const std::vector<std::vector<size_t>>& clusters,
+                   const SolveBudget& budget,
+                   std::vector<AIG::Lit>& diffs,
+                   std::vector<char>& differs,
+                   std::vector<char>& undecided,
+                   tbb::concurrent_vector<naja::DNL::DNLID>& failed,
+                   SolverStats& stats) {
+  // extractCones() leaves its map clean, one per worker serves every
+  // extraction, overlapping cones included
+  tbb::enumerable_thread_specific<std::vector<AIG::Lit>> maps(
+      aig.getNumNodes(), AIG::kNoLit);
+  SolverStatsETS workerStats;
+  std::vector<char> equal(clusters.size(), 0);
+  auto checkCluster = [&](size_t c) {
+    std::vector<AIG::Lit> subRoots = {miters[c]};
+    for (size_t i : clusters[c]) {
+      subRoots.push_back(diffs[i]);
+    }
+    SolverCall call;
+    const AIG sub = extractCones(aig, subRoots, maps.local());
+    const std::vector<AIG::Lit> subDiffs(subRoots.begin() + 1, subRoots.end());
+    Glucose::SimpSolver S;
+    std::vector<int> node2var;
+    Glucose::Lit rootLit = tseitinEncode(S, sub, subRoots[0], node2var);
+    auto diffLits =
+        encodeOutputPairs(S, sub, subDiffs, 0, subDiffs.size(), node2var);
+    S.setFrozen(Glucose::var(rootLit), true);
+    call.encoded(S);
+    Glucose::vec<Glucose::Lit> assumps;
+    assumps.push(rootLit);
+    const Glucose::lbool result = budget.solve(S, assumps);
+    if (result == l_False) {
+      equal[c] = 1;
+      workerStats.local().add(S, call);
+      return;
+    }
+    std::vector<char> subDiffers(subDiffs.size(), 0);
+    std::vector<char> subUndecided(subDiffs.size(), 0);
+    tbb::concurrent_vector<naja::DNL::DNLID> subFailed;
+    if (result == l_True) {
+      collectDiffs(S, diffLits, 0, 0, subDiffers, subFailed);
+    }
+    checkOutputPairs(S, diffLits, 0, subDiffs, budget, true, subDiffers,
+                     subUndecided, subFailed);
+    workerStats.local().add(S, call);
+    // clusters own disjoint pairs: no two workers write the same entry
+    for (size_t i : subFailed) {
+      differs[clusters[c][i]] = 1;
+      failed.push_back(clusters[c][i]);
+    }
+    for (size_t i = 0; i < subUndecided.size(); ++i) {
+      undecided[clusters[c][i]] |= subUndecided[i];
+    }
+  };
+  if (!Concurrency::isParallel()) {
+    for (size_t c = 0; c < clusters.size(); ++c) {
+      checkCluster(c);
+    }
+  } else {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, clusters.size(), 1),
+                      [&](const tbb::blocked_range<size_t>& r) {
+                        for (size_t c = r.begin(); c < r.end(); ++c) {
+                          checkCluster(c);
+                        }
+                      });
+  }
+  stats = combine(workerStats);
+  size_t numEqual = 0;
+  for (size_t c = 0; c < clusters.size(); ++c) {
+    if (!equal[c]) continue;
+    ++numEqual;
+    for (size_t i : clusters[c]) {
+      diffs[i] = AIG::kFalse;
+    }
+  }
+  logger->info("Clustered miters: {} of {} clusters proven equal", numEqual,
+               clusters.size());
+}
 
-    // Children have been processed; retrieve their lits
-    if (e->getLeft())
-      fr.leftLit = result[e->getLeft()];
-    if (e->getRight())
-      fr.rightLit = result[e->getRight()];
+// Retries the undecided pairs, each on a solver of its own over its cone
+// alone, the per-check limits growing level by level up to the escalations
+// of the budget. Pairs are independent and retried in parallel; the ones
+// still out of budget after the last level stay in `undecided`.
+void escalateUndecided(const AIG& aig,
+                       const std::vector<AIG::Lit>& diffs,
+                       const SolveBudget& budget,
+                       std::vector<char>& differs,
+                       std::vector<char>& undecided,
+                       tbb::concurrent_vector<naja::DNL::DNLID>& failed) {
+  std::vector<size_t> pending;
+  for (size_t i = 0; i < undecided.size(); ++i) {
+    if (undecided[i]) pending.push_back(i);
+  }
+  // extractCones() leaves its map clean, one per worker serves every retry
+  tbb::enumerable_thread_specific<std::vector<AIG::Lit>> maps(
+      aig.getNumNodes(), AIG::kNoLit);
+  for (unsigned level = 1; level <= budget.getLimits().escalations &&
+                           !pending.empty() && !budget.isExhausted();
+       ++level) {
+    logger->info("Escalation {}: retrying {} undecided output pairs", level,
+                 pending.size());
+    PerfReport::Phase phase("escalation");
+    SolverStatsETS workerStats;
+    auto retry = [&](size_t k) {
+      const size_t i = pending[k];
+      SolverCall call;
+      std::vector<AIG::Lit> roots = {diffs[i]};
+      const AIG sub = extractCones(aig, roots, maps.local());
+      Glucose::SimpSolver S;
+      std::vector<int> node2var;
+      Glucose::vec<Glucose::Lit> assumps;
+      assumps.push(tseitinEncode(S, sub, roots[0], node2var));
+      call.encoded(S);
+      const Glucose::lbool result = budget.solve(S, assumps, true, level);
+      workerStats.local().add(S, call);
+      if (result == l_Undef) return;
+      // pending pairs are distinct: no two workers write the same entry
+      undecided[i] = 0;
+      if (result == l_True) {
+        differs[i] = 1;
+        failed.push_back(i);
+      }
+    };
+    if (!Concurrency::isParallel()) {
+      for (size_t k = 0; k < pending.size(); ++k) {
+        retry(k);
+      }
+    } else {
+      tbb::parallel_for(tbb::blocked_range<size_t>(0, pending.size(), 1),
+                        [&](const tbb::blocked_range<size_t>& r) {
+                          for (size_t k = r.begin(); k < r.end(); ++k) {
+                            retry(k);
+                          }
+                        });
+    }
+    const size_t retried = pending.size();
+    std::erase_if(pending, [&](size_t i) { return !undecided[i]; });
+    phase.add("level", level)
+        .add("outputs", retried)
+        .add("undecided", pending.size());
+    combine(workerStats).report(phase);
+  }
+}
 
-    // Create fresh var for this gate
-    int v = S.newVar();
-    Glucose::Lit lit_v = Glucose::mkLit(v);
-    node2var[e] = v;
-    result[e] = lit_v;
+// Failing outputs that get a minimized counterexample and a replay
+constexpr size_t kMaxCounterexamples = 32;
 
-    logger->trace("Encoding node op={} as var {}", static_cast<int>(e->getOp()),
-                  v);
+// Hierarchical name of a terminal of the current DNL: instance path, pin
+std::string getTermName(naja::DNL::DNLID id) {
+  const auto& term = naja::DNL::get()->getDNLTerminalFromID(id);
+  std::string name;
+  for (const auto& n : term.getDNLInstance().getPath().getPathNames()) {
+    name += n.getString() + "/";
+  }
+  return name + term.getSnlBitTerm()->getString();
+}
 
-    // Emit Tseitin clauses
-    switch (e->getOp()) {
-      case Op::NOT:
-        S.addClause(~lit_v, ~fr.leftLit);
-        S.addClause(lit_v, fr.leftLit);
-        break;
-      case Op::AND:
-        S.addClause(~lit_v, fr.leftLit);
-        S.addClause(~lit_v, fr.rightLit);
-        S.addClause(lit_v, ~fr.leftLit, ~fr.rightLit);
-        break;
-      case Op::OR:
-        S.addClause(~fr.leftLit, lit_v);
-        S.addClause(~fr.rightLit, lit_v);
-        S.addClause(~lit_v, fr.leftLit, fr.rightLit);
-        break;
-      case Op::XOR:
-        S.addClause(~lit_v, ~fr.leftLit, ~fr.rightLit);
-        S.addClause(~lit_v, fr.leftLit, fr.rightLit);
-        S.addClause(lit_v, ~fr.leftLit, fr.rightLit);
-        S.addClause(lit_v, fr.leftLit, ~fr.rightLit);
-        break;
-      default:
-        logger->warn("Unhandled operator in tseitinEncode: {}",
-                     static_cast<int>(e->getOp()));
-        break;
+// Distinguishing input cube of a differing pair: read from the simulation
+// pattern that found it, else from a model of its cone alone, solved with
+// the limits of the last escalation. The cube is minimized to the inputs that
+// force the difference; none when the model is out of budget.
+std::optional<InputCube> extractCounterexample(const AIG& aig,
+                                               AIG::Lit diff,
+                                               size_t pattern,
+                                               const SolveBudget& budget) {
+  std::vector<AIG::Lit> map(aig.getNumNodes(), AIG::kNoLit);
+  std::vector<AIG::Lit> roots = {diff};
+  const AIG sub = extractCones(aig, roots, map);
+  InputCube cube;
+  if (pattern != (size_t)-1) {
+    for (uint32_t node = 1; node < sub.getNumNodes(); ++node) {
+      if (!sub.isInput(node)) continue;
+      const size_t varId = sub.getInputVarId(node);
+      const uint64_t word = BoolExprSimulator::inputWord(
+          BoolExprSimulator::kDefaultSeed, varId, pattern / 64);
+      cube.emplace_back(varId, (word >> (pattern % 64)) & 1);
+    }
+  } else {
+    Glucose::SimpSolver S;
+    std::vector<int> node2var;
+    Glucose::vec<Glucose::Lit> assumps;
+    assumps.push(tseitinEncode(S, sub, roots[0], node2var));
+    if (budget.solve(S, assumps, false, budget.getLimits().escalations) !=
+        l_True) {
+      // LCOV_EXCL_START
+      return std::nullopt;
+      // LCOV_EXCL_STOP
+    }
+    for (uint32_t node = 1; node < sub.getNumNodes(); ++node) {
+      if (!sub.isInput(node)) continue;
+      cube.emplace_back(sub.getInputVarId(node),
+                        S.modelValue(node2var[node]) == l_True);
     }
-
-    stk.pop();
   }
+  minimizeCube(sub, roots[0], cube);
+  return cube;
+}
 
-  logger->debug("Finished Tseitin encode");
-  return result.at(root);
+// Evaluates both designs on each vector of a stimulus file, names being the
+// ones of design 0 (see getTermName)
+void replayStimulus(const std::string& path,
+                    const AIG& aig,
+                    const std::vector<AIG::Lit>& POs0,
+                    const std::vector<AIG::Lit>& POs1,
+                    const std::vector<std::string>& inputNames,
+                    const std::vector<std::string>& outputNames) {
+  MiterStimulus stimulus;
+  if (!stimulus.load(path)) {
+    logger->warn("Could not read stimulus file {}", path);
+    return;
+  }
+  std::unordered_map<std::string, size_t> name2var;
+  for (size_t i = 0; i < inputNames.size(); ++i) {
+    name2var[inputNames[i]] = i + 2;
+  }
+  std::unordered_map<std::string, size_t> name2output;
+  for (size_t i = 0; i < outputNames.size(); ++i) {
+    name2output[outputNames[i]] = i;
+  }
+  for (const auto& vector : stimulus.getVectors()) {
+    auto output = name2output.find(vector.output);
+    if (output == name2output.end() || output->second >= POs1.size()) {
+      logger->warn("Replay: unknown output {}", vector.output);
+      continue;
+    }
+    InputCube cube;
+    for (const auto& [name, value] : vector.inputs) {
+      auto var = name2var.find(name);
+      if (var == name2var.end()) {
+        logger->warn("Replay: unknown input {}, left at 0", name);
+        continue;
+      }
+      cube.emplace_back(var->second, value);
+    }
+    const bool value0 = evaluateCube(aig, POs0[output->second], cube);
+    const bool value1 = evaluateCube(aig, POs1[output->second], cube);
+    logger->info("Replay of {}: {} vs {}{}", vector.output, value0 ? 1 : 0,
+                 value1 ? 1 : 0, value0 != value1 ? " (different)" : "");
+  }
 }
 
 }  // namespace
@@ -347,7 +640,7 @@ void MiterStrategy::normalizeInputs(
   }
   inputs0.insert(inputs0.end(), diff0.begin(), diff0.end());
   for (size_t i = 0; i < inputs0.size(); ++i) {
-    logger->info("normalized input0[{}]: DNLID {}", i, inputs0[i]);
+    MITER_TRACE("normalized input0[{}]: DNLID {}", i, inputs0[i]);
   }
   inputs1.clear();
   for (const auto& path : pathsCommon) {
@@ -355,7 +648,7 @@ void MiterStrategy::normalizeInputs(
   }
   inputs1.insert(inputs1.end(), diff1.begin(), diff1.end());
   for (size_t i = 0; i < inputs1.size(); ++i) {
-    logger->info("normalized input1[{}]: DNLID {}", i, inputs1[i]);
+    MITER_TRACE("normalized input1[{}]: DNLID {}", i, inputs1[i]);
   }
   logger->info("size of common inputs: {}", pathsCommon.size());
   logger->info("size of diff0 inputs: {}", diff0.size());
@@ -469,20 +762,35 @@ void MiterStrategy::normalizeOutputs(
 }
 
 bool MiterStrategy::run() {
+  // every parallel phase below runs in the configured arena
+  return Concurrency::execute([this] { return runInArena(); });
+}
+
+bool MiterStrategy::runInArena() {
   ensureLoggerInitialized();
-  logger->info("MiterStrategy::run starting");
-
-  // build both sets of POs
-  topInit_ = NLUniverse::get()->getTopDesign();
-  NLUniverse* univ = NLUniverse::get();
-  naja::DNL::destroy();
-  univ->setTopDesign(top0_);
-  BuildPrimaryOutputClauses builder0;
-  builder0.collect();
-  naja::DNL::destroy();
-  univ->setTopDesign(top1_);
-  BuildPrimaryOutputClauses builder1;
-  builder1.collect();
+  logger->info("MiterStrategy::run starting on {} threads",
+               Concurrency::getNumThreads());
+
+  PerfReport::Phase runPhase("miter_run");
+
+  // Every switch rebuilds the DNL, so the steps are ordered per design:
+  // collect 0, collect 1, then both builds at once, design 1 on a copy of
+  // its DNL and design 0 on the current one. The switcher restores the
+  // universe top design when the run returns.
+  DNLSwitcher designs;
+  const DNLSwitcher::Handle handles[2] = {designs.add(top0_),
+                                         designs.add(top1_)};
+  BuildPrimaryOutputClauses builders[2];
+  for (size_t j = 0; j < 2; ++j) {
+    designs.switchTo(handles[j]);
+    PerfReport::Phase phase("collect");
+    builders[j].collect();
+    phase.add("design", j)
+        .add("inputs", builders[j].getInputs().size())
+        .add("outputs", builders[j].getOutputs().size());
+  }
+  BuildPrimaryOutputClauses& builder0 = builders[0];
+  BuildPrimaryOutputClauses& builder1 = builders[1];
 
   // normalize inputs and outputs
   auto inputs0sort = builder0.getInputs();
@@ -493,41 +801,94 @@ bool MiterStrategy::run() {
   logger->info("size of PIs in circuit 1: {}", inputs1sort.size());
   logger->info("size of POs in circuit 0: {}", outputs0sort.size());
   logger->info("size of POs in circuit 1: {}", outputs1sort.size());
+  PerfReport::Phase normalizePhase("normalize");
   normalizeInputs(inputs0sort, inputs1sort, builder0.getInputsMap(),
                   builder1.getInputsMap());
   normalizeOutputs(outputs0sort, outputs1sort, builder0.getOutputsMap(),
                    builder1.getOutputsMap());
+  normalizePhase.add("inputs", inputs0sort.size())
+      .add("outputs", outputs0sort.size())
+      .stop();
   // return false;
-  naja::DNL::destroy();
-  univ->setTopDesign(top0_);
-  builder0.setInputs(inputs0sort);
-  builder0.setOutputs(outputs0sort);
-  naja::DNL::destroy();
-  univ->setTopDesign(top1_);
+  designs.switchTo(handles[1]);
   builder1.setInputs(inputs1sort);
   builder1.setOutputs(outputs1sort);
-  naja::DNL::destroy();
-  univ->setTopDesign(top0_);
-  builder0.build();
+  std::unique_ptr<naja::DNL::DNLFull> dnl1 = designs.copy(handles[1]);
+  designs.switchTo(handles[0]);
+  builder0.setInputs(inputs0sort);
+  builder0.setOutputs(outputs0sort);
+  builder1.setDNL(dnl1.get());
+  // Cone hashes see each input through its pairing: an input found in one
+  // design only may get another partner when inputs are added elsewhere
+  {
+    std::vector<std::pair<std::vector<NLName>,
+                          std::vector<NLID::DesignObjectID>>>
+        paths[2];
+    for (size_t j = 0; j < 2; ++j) {
+      for (auto input : builders[j].getInputs()) {
+        paths[j].push_back(builders[j].getInputs2InputsIDs().at(input));
+      }
+    }
+    const auto inputHashes =
+        BuildPrimaryOutputClauses::getPairedInputHashes(paths[0], paths[1]);
+    builder0.setInputHashes(inputHashes);
+    builder1.setInputHashes(inputHashes);
+  }
+  for (auto* builder : {&builder0, &builder1}) {
+    builder->setBuildAIG(true);
+    builder->setReleaseDNL(false);
+  }
+  if (Concurrency::isParallel()) {
+    tbb::parallel_invoke([&] { builder0.build(); }, [&] { builder1.build(); });
+  } else {
+    builder0.build();
+    builder1.build();
+  }
+  dnl1.reset();
   const auto& PIs0 = builder0.getInputs();
-  const auto& POs0 = builder0.getPOs();
   auto outputs0 = builder0.getOutputs();
-  auto inputs2inputsIDs0 = builder0.getInputs2InputsIDs();
-  auto outputs2outputsIDs0 = builder0.getOutputs2OutputsIDs();
-  naja::DNL::destroy();
-  univ->setTopDesign(top1_);
-  builder1.build();
   const auto& PIs1 = builder1.getInputs();
-  const auto& POs1 = builder1.getPOs();
   auto outputs1 = builder1.getOutputs();
-  auto inputs2inputsIDs1 = builder1.getInputs2InputsIDs();
-  auto outputs2outputsIDs1 = builder1.getOutputs2OutputsIDs();
-
-  std::vector<naja::DNL::DNLID> outputs2DnlIds = builder1.getOutputs();
+  // Pin names of design 0 for the counterexamples; normalized inputs and
+  // outputs have the same names in both designs
+  std::vector<std::string> inputNames;
+  std::vector<std::string> outputNames;
+  inputNames.reserve(PIs0.size());
+  for (auto input : PIs0) {
+    inputNames.push_back(getTermName(input));
+  }
+  outputNames.reserve(outputs0.size());
+  for (auto output : outputs0) {
+    outputNames.push_back(getTermName(output));
+  }
 
-  if (topInit_ != nullptr) {
-    univ->setTopDesign(topInit_);
+  // Both designs in one AIG: inputs are shared through their var id and the
+  // logic the two designs have in common is strashed together.
+  PerfReport::Phase mergePhase("aig_merge");
+  AIG aig = std::move(builder0.getAIG());
+  std::vector<AIG::Lit> POs0 = builder0.getPOLits();
+  std::vector<AIG::Lit> POs1;
+  {
+    auto map1 = aig.append(builder1.getAIG());
+    for (AIG::Lit lit : builder1.getPOLits()) {
+      assert(lit != AIG::kNoLit);
+      POs1.push_back(AIG::remapLit(map1, lit));
+    }
+  }
+  // Outputs whose cones are structurally identical in both designs are now
+  // the same literal: their pair XOR folds to kFalse and needs no SAT call
+  size_t numStrashedEqual = 0;
+  for (size_t i = 0; i < std::min(POs0.size(), POs1.size()); ++i) {
+    numStrashedEqual += POs0[i] == POs1[i];
   }
+  mergePhase.add("inputs", aig.getNumInputs())
+      .add("and_nodes", aig.getNumAnds())
+      .add("strashed_equal_outputs", numStrashedEqual)
+      .stop();
+  logger->info(
+      "AIG of both designs: {} inputs, {} and nodes, {} output pairs "
+      "structurally equal",
+      aig.getNumInputs(), aig.getNumAnds(), numStrashedEqual);
 
   if (POs0.empty() || POs1.empty()) {
     logger->warn(
@@ -535,30 +896,283 @@ bool MiterStrategy::run() {
     return false;
   }
 
-  // build the Boolean-miter expression
-  auto miter = buildMiter(POs0, POs1);
+  const size_t numPairs = std::min(POs0.size(), POs1.size());
 
-  // Now SAT check via Glucose
+  if (!replayFile_.empty()) {
+    replayStimulus(replayFile_, aig, POs0, POs1, inputNames, outputNames);
+  }
+
+  // Incremental runs: a pair proven equivalent by an earlier run whose cones
+  // hash the same in both designs is tied to a single literal, so simulation
+  // and SAT see it as trivially equal.
+  MiterResultCache resultCache;
+  std::vector<uint64_t> outputKeys;
+  const auto& coneHashes0 = builder0.getPOConeHashes();
+  const auto& coneHashes1 = builder1.getPOConeHashes();
+  if (!resultCacheFile_.empty()) {
+    if (!resultCache.load(resultCacheFile_)) {
+      logger->info("No usable result cache in {}, starting a new one",
+                   resultCacheFile_);
+    }
+    size_t reused = 0;
+    outputKeys.resize(numPairs);
+    for (size_t i = 0; i < numPairs; ++i) {
+      outputKeys[i] = BuildPrimaryOutputClauses::getPathHash(
+          builder0.getOutputs2OutputsIDs().at(outputs0[i]));
+      if (resultCache.isKnownEquivalent(outputKeys[i], coneHashes0[i],
+                                        coneHashes1[i])) {
+        POs1[i] = POs0[i];
+        ++reused;
+      }
+    }
+    logger->info("Result cache: {} of {} output pairs unchanged and equivalent",
+                 reused, numPairs);
+    PerfReport::record("result_cache", 0,
+                       {{"outputs", static_cast<double>(numPairs)},
+                        {"hits", static_cast<double>(reused)}});
+  }
+
+  // Every SAT call from here on runs within the solver limits; the total
+  // time counts from now
+  const SolveBudget budget(solverLimits_);
+
+  // SAT sweeping: internal points the two designs have in common are proved
+  // equivalent bottom-up and merged, leaving the output miters with the logic
+  // that actually differs.
+  if (satSweeping_) {
+    PerfReport::Phase phase("sat_sweep");
+    std::vector<AIG::Lit> roots = POs0;
+    roots.insert(roots.end(), POs1.begin(), POs1.end());
+    AIGSweeper sweeper(aig);
+    sweeper.setSolveBudget(&budget);
+    AIG swept = sweeper.sweep(roots);
+    aig = std::move(swept);
+    std::copy(roots.begin(), roots.begin() + POs0.size(), POs0.begin());
+    std::copy(roots.begin() + POs0.size(), roots.end(), POs1.begin());
+    logger->info(
+        "SAT sweeping: {} nodes merged, {} candidates disproved, {} undecided, "
+        "{} and nodes left",
+        sweeper.getNumProved(), sweeper.getNumDisproved(),
+        sweeper.getNumUndecided(), aig.getNumAnds());
+    phase.add("proved", sweeper.getNumProved())
+        .add("disproved", sweeper.getNumDisproved())
+        .add("undecided", sweeper.getNumUndecided())
+        .add("and_nodes", aig.getNumAnds());
+  }
+
+  // Output pair XORs, kFalse when both sides strashed to the same literal
+  std::vector<AIG::Lit> diffs(numPairs);
+  for (size_t i = 0; i < numPairs; ++i) {
+    diffs[i] = aig.createXor(POs0[i], POs1[i]);
+  }
+
+  // Cheap bit-parallel random simulation first: both designs see the same
+  // stimulus per normalized input, so a pair whose signatures differ is
+  // non-equivalent, comes with a concrete witness and needs no SAT call.
+  std::vector<char> differs(numPairs, 0);
+  // pairs whose check ran out of budget
+  std::vector<char> undecided(numPairs, 0);
+  // first differing simulation pattern of each pair, -1 if none
+  std::vector<size_t> witnessPatterns(numPairs, (size_t)-1);
+  {
+    PerfReport::Phase phase("simulation");
+    BoolExprSimulator sim;
+    for (size_t i = 0; i < numPairs; ++i) {
+      sim.addRoot(aig, POs0[i]);
+      sim.addRoot(aig, POs1[i]);
+    }
+    sim.run(kSimulationWords);
+    auto inputName = [&](size_t varId) {
+      const size_t index = varId - 2;
+      const auto& path =
+          index < PIs0.size()
+              ? builder0.getInputs2InputsIDs().at(PIs0[index])
+              : builder1.getInputs2InputsIDs().at(PIs1[index]);
+      std::string name;
+      for (const auto& n : path.first) {
+        name += n.getString() + ".";
+      }
+      for (const auto& id : path.second) {
+        name += std::to_string(id) + ".";
+      }
+      return name;
+    };
+    for (size_t i = 0; i < numPairs; ++i) {
+      const size_t pattern = sim.firstDifference(2 * i, 2 * i + 1);
+      if (pattern == (size_t)-1) {
+        continue;
+      }
+      differs[i] = 1;
+      witnessPatterns[i] = pattern;
+      failedPOs_.push_back(i);
+      // the support walk spans the simulator: witnesses of the first
+      // failures only, the ones that also get a counterexample
+      if (failedPOs_.size() > kMaxCounterexamples) {
+        continue;
+      }
+      std::string witness;
+      for (size_t varId : sim.getSupport({2 * i, 2 * i + 1})) {
+        witness += inputName(varId) + "=" +
+                   (sim.getInputValue(varId, pattern) ? "1 " : "0 ");
+      }
+      logger->info("Simulation witness for PO {}: {}", i, witness);
+    }
+    if (failedPOs_.size() > kMaxCounterexamples) {
+      logger->info("Simulation witnesses of {} more output pairs omitted",
+                   failedPOs_.size() - kMaxCounterexamples);
+    }
+    logger->info("Simulation disproved {} of {} output pairs",
+                 failedPOs_.size(), numPairs);
+    phase.add("patterns", kSimulationWords * 64)
+        .add("outputs", numPairs)
+        .add("disproved", failedPOs_.size());
+  }
+
+  // Now SAT check via Glucose. One persistent solver holds the CNF of both
+  // designs: each output pair XOR is encoded once and its literal is used as
+  // the activation assumption of the per-PO checks, so nothing is re-encoded
+  // and learnt clauses carry over from one output to the next.
   Glucose::SimpSolver solver;
 
-  // mappings for Tseitin encoding
-  std::unordered_map<std::shared_ptr<BoolExpr>, int> node2var;
-  std::unordered_map<std::string, int> varName2idx;
+  // mapping for Tseitin encoding
+  std::vector<int> node2var;
+  std::vector<Glucose::Lit> diffLits;
 
-  // Tseitin-encode & get the literal for the root
-  Glucose::Lit rootLit = tseitinEncode(solver, miter, node2var, varName2idx);
+  bool sat = !failedPOs_.empty();
+  // set once the clusters checked their pairs themselves
+  bool pairsChecked = false;
+  if (!sat) {
+    // build the Boolean miters, one per support cluster
+    std::vector<std::vector<size_t>> clusters;
+    std::vector<AIG::Lit> miters = buildMiters(aig, POs0, POs1, clusters);
+    if (clusteredMiters_ && miters.size() > 1) {
+      logger->info("Solving {} independent output clusters", miters.size());
+      PerfReport::Phase phase("cluster_solve");
+      SolverStats stats;
+      checkClusters(aig, miters, clusters, budget, diffs, differs, undecided,
+                    failedPOs_, stats);
+      phase.add("clusters", miters.size()).add("failed", failedPOs_.size());
+      stats.report(phase);
+      sat = !failedPOs_.empty();
+      pairsChecked = true;
+    } else {
+      AIG::Lit miter = createBalancedOr(aig, miters);
 
-  // Assert root == true
-  solver.addClause(rootLit);
+      // Tseitin-encode & get the literal for the root
+      PerfReport::Phase tseitinPhase("tseitin");
+      Glucose::Lit rootLit = tseitinEncode(solver, aig, miter, node2var);
 
-  // solve with no assumptions
-  logger->info("Started Glucose solving");
-  bool sat = solver.solve();
-  logger->info("Finished Glucose solving: {}", sat ? "SAT" : "UNSAT");
+      // The pair XORs are strashed, so the pairs below are node2var hits on
+      // the miter cone.
+      diffLits = encodeOutputPairs(solver, aig, diffs, 0, numPairs, node2var);
+      solver.setFrozen(Glucose::var(rootLit), true);
+      tseitinPhase.add("vars", solver.nVars())
+          .add("clauses", solver.nClauses())
+          .stop();
+
+      // Assume root == true (kept as an assumption so the solver stays
+      // reusable)
+      Glucose::vec<Glucose::Lit> assumps;
+      assumps.push(rootLit);
+      logger->info("Started Glucose solving");
+      PerfReport::Phase solvePhase("sat_solve");
+      const Glucose::lbool result = budget.solve(solver, assumps);
+      sat = result == l_True;
+      solvePhase.add("sat", sat)
+          .add("undecided", result == l_Undef)
+          .add("conflicts", solver.conflicts)
+          .add("decisions", solver.decisions)
+          .add("propagations", solver.propagations)
+          .stop();
+      logger->info("Finished Glucose solving: {}",
+                   sat                  ? "SAT"
+                   : result == l_False ? "UNSAT"
+                                        : "UNDECIDED");
+      if (sat) {
+        // Every satisfying assignment may already witness several differing
+        // outputs; those need no dedicated solve call.
+        collectDiffs(solver, diffLits, 0, 0, differs, failedPOs_);
+      } else if (result == l_Undef) {
+        logger->warn("Miter undecided within the solver limits -> checking "
+                     "individual POs");
+      }
+      // UNSAT: every pair is equal, nothing left to check
+      pairsChecked = result == l_False;
+    }
+  }
 
   if (sat) {
     logger->warn("Miter found a difference -> moving to analyze individual POs");
-    for (size_t i = 0; i < POs0.size(); ++i) {
+  }
+  if (!pairsChecked) {
+    // The pairs are split into contiguous partitions, each checked by its
+    // own solver of a pool bounded by the arena concurrency. A single
+    // partition keeps using the solver of the global miter; clustered miters
+    // have checked their pairs already.
+    PerfReport::Phase pairPhase("pair_checks");
+    SolverStats stats;
+    const size_t numSolvers = std::min<size_t>(
+        Concurrency::getNumThreads(),
+        (numPairs + kMinPairsPerSolver - 1) / kMinPairsPerSolver);
+    if (numSolvers == 1) {
+      // the global miter, when it ran, has solved and simplified this solver
+      const bool simplified = !diffLits.empty();
+      SolverCall call;
+      if (diffLits.empty()) {
+        diffLits = encodeOutputPairs(solver, aig, diffs, 0, numPairs, node2var);
+      }
+      call.encoded(solver);
+      checkOutputPairs(solver, diffLits, 0, diffs, budget, simplified,
+                       differs, undecided, failedPOs_);
+      stats.add(solver, call);
+    } else if (numSolvers > 1) {
+      SolverStatsETS workerStats;
+      logger->info("Checking {} output pairs with {} solvers", numPairs,
+                   numSolvers);
+      tbb::parallel_for(
+          tbb::blocked_range<size_t>(0, numSolvers, 1),
+          [&](const tbb::blocked_range<size_t>& r) {
+            for (size_t p = r.begin(); p < r.end(); ++p) {
+              const size_t begin = p * numPairs / numSolvers;
+              const size_t end = (p + 1) * numPairs / numSolvers;
+              SolverCall call;
+              Glucose::SimpSolver partSolver;
+              std::vector<int> partNode2var;
+              auto partLits = encodeOutputPairs(partSolver, aig, diffs, begin,
+                                                end, partNode2var);
+              call.encoded(partSolver);
+              checkOutputPairs(partSolver, partLits, begin, diffs, budget,
+                               false, differs, undecided, failedPOs_);
+              workerStats.local().add(partSolver, call);
+            }
+          });
+      stats = combine(workerStats);
+    }
+    pairPhase.add("solvers", numSolvers)
+        .add("failed", failedPOs_.size())
+        .add("undecided", std::count(undecided.begin(), undecided.end(), 1));
+    stats.report(pairPhase);
+    pairPhase.stop();
+  }
+
+  // Pairs out of budget get stronger limits on their cone alone; the ones
+  // still undecided after that are reported as such
+  if (std::find(undecided.begin(), undecided.end(), 1) != undecided.end()) {
+    escalateUndecided(aig, diffs, budget, differs, undecided, failedPOs_);
+  }
+  for (size_t i = 0; i < numPairs; ++i) {
+    if (undecided[i]) {
+      undecidedPOs_.push_back(i);
+      logger->warn("Undecided PO {} within the solver limits: {}", i,
+                   outputNames[i]);
+    }
+  }
+  // Workers report in completion order; diagnose in output order.
+  std::sort(failedPOs_.begin(), failedPOs_.end());
+  sat = !failedPOs_.empty();
+
+  if (sat) {
+    for (size_t i = 0; i < numPairs; ++i) {
       if (builder0.getOutputs2OutputsIDs().at(builder0.getDNLIDforOutput(i)) !=
           builder1.getOutputs2OutputsIDs().at(builder1.getDNLIDforOutput(i))) {
         // LCOV_EXCL_START
@@ -584,271 +1198,335 @@ bool MiterStrategy::run() {
                                  " DNLIDs do not match");
         // LCOV_EXCL_STOP
       }
-      tbb::concurrent_vector<std::shared_ptr<BoolExpr>> singlePOs0S;
-      singlePOs0S.push_back(POs0[i]);
-      tbb::concurrent_vector<std::shared_ptr<BoolExpr>> singlePOs1S;
-      singlePOs1S.push_back(POs1[i]);
-      auto singleMiter = buildMiter(singlePOs0S, singlePOs1S);
-
-      std::unordered_map<std::shared_ptr<BoolExpr>, int> singleNode2var;
-      std::unordered_map<std::string, int> singleVarName2idx;
-      // Tseitin-encode the single miter
-      Glucose::SimpSolver singleSolver;
-      Glucose::Lit singleRootLit = tseitinEncode(
-          singleSolver, singleMiter, singleNode2var, singleVarName2idx);
-
-      singleSolver.addClause(singleRootLit);
-      if (singleSolver.solve()) {
-        failedPOs_.push_back(i);
-        logger->info("Found difference for PO: {}", i);
-        // logger->info("Clause 0 {}", POs0[i]->toString());
-        // logger->info("Clause 1 {}", POs1[i]->toString());
-        // print path of index i
-        auto path0 = builder0.getOutputs2OutputsIDs().at(builder0.getDNLIDforOutput(i));
-        std::string pathString = "";
-        for (const auto& name : path0.first) {
-          pathString += name.getString() + ".";
-        }
-        for (const auto& id : path0.second) {
-          pathString += std::to_string(id) + ".";
-        }
-        logger->info("Path of differing PO {}: {}", i, pathString);
-        auto path1 = builder1.getOutputs2OutputsIDs().at(builder1.getDNLIDforOutput(i));
-        std::string pathString1 = "";
-        for (const auto& name : path1.first) {
-          pathString1 += name.getString() + ".";
-        }
-        for (const auto& id : path1.second) {
-          pathString1 += std::to_string(id) + ".";
-        }
-        logger->info("Path of differing PO {}: {}", i, pathString1);
-        std::vector<naja::NL::SNLDesign*> topModels;
-        topModels.push_back(top0_);
-        topModels.push_back(top1_);
-        std::vector<std::vector<naja::DNL::DNLID>> PIs;
-        PIs.push_back(PIs0);
-        PIs.push_back(PIs1);
-        naja::NL::SNLEquipotential::Terms terms0;
-        naja::NL::SNLEquipotential::Terms terms1;
-        naja::NL::SNLEquipotential::InstTermOccurrences insTerms0;
-        naja::NL::SNLEquipotential::InstTermOccurrences insTerms1;
-        for (size_t j = 0; j < topModels.size(); ++j) {
-          DNL::destroy();
-          NLUniverse::get()->setTopDesign(topModels[j]);
-          // if (j == 0) {
-          //   //logger->info("$$$ 0 term {} of model {}",
-          //   naja::DNL::get()->getDNLTerminalFromID(outputs0[i]).getSnlBitTerm()->getName().getString().c_str(),
-          //   naja::DNL::get()->getDNLTerminalFromID(outputs0[i]).getSnlBitTerm()->getDesign()->getName().getString().c_str());
-          // } else {
-          //   //logger->info("### 0 term {} of model {}",
-          //   naja::DNL::get()->getDNLTerminalFromID(outputs1[i]).getSnlBitTerm()->getName().getString().c_str(),
-          //   naja::DNL::get()->getDNLTerminalFromID(outputs1[i]).getSnlBitTerm()->getDesign()->getName().getString().c_str());
-
-          // }
-          if (dnls_.size() <= j) {
-            dnls_.push_back(*naja::DNL::get());
+    }
+
+    // Concrete distinguishing vectors, minimized, for the first failures
+    PerfReport::Phase counterexamplePhase("counterexamples");
+    std::unordered_map<size_t, InputCube> counterexamples;
+    MiterStimulus stimulus;
+    for (size_t k = 0; k < std::min(failedPOs_.size(), kMaxCounterexamples);
+         ++k) {
+      const size_t i = failedPOs_[k];
+      std::optional<InputCube> found =
+          extractCounterexample(aig, diffs[i], witnessPatterns[i], budget);
+      if (!found) {
+        // LCOV_EXCL_START
+        logger->warn("No counterexample for PO {} within the solver limits",
+                     i);
+        continue;
+        // LCOV_EXCL_STOP
+      }
+      InputCube& cube = *found;
+      MiterStimulus::Vector vector{outputNames[i], {}};
+      std::string cubeString;
+      for (const auto& [varId, value] : cube) {
+        vector.inputs.emplace_back(inputNames[varId - 2], value);
+        cubeString += inputNames[varId - 2] + "=" + (value ? "1 " : "0 ");
+      }
+      logger->info("Counterexample for PO {} ({} inputs): {}", i, cube.size(),
+                   cubeString);
+      stimulus.add(std::move(vector));
+      counterexamples.emplace(i, std::move(cube));
+    }
+    if (!counterexampleFile_.empty()) {
+      if (stimulus.save(counterexampleFile_)) {
+        logger->info("Wrote {} counterexamples to {}", stimulus.size(),
+                     counterexampleFile_);
+      } else {
+        logger->warn("Could not write counterexamples to {}",
+                     counterexampleFile_);
+      }
+    }
+    counterexamplePhase.add("vectors", counterexamples.size()).stop();
+
+    PerfReport::Phase diagnosisPhase("diagnosis");
+    diagnosisPhase.add("outputs", failedPOs_.size());
+    // Cone terms of the differing outputs, gathered design by design so each
+    // DNL is rebuilt at most once, the current one first
+    struct OutputCone {
+      naja::NL::SNLEquipotential::Terms terms;
+      naja::NL::SNLEquipotential::InstTermOccurrences insTerms;
+      uint64_t replayWord = 0;  // 64 completions of the counterexample
+    };
+    std::vector<std::array<OutputCone, 2>> cones(failedPOs_.size());
+    const size_t firstDesign = designs.getCurrent() == handles[1] ? 1 : 0;
+    for (size_t d = 0; d < 2 && !failedPOs_.empty(); ++d) {
+      const size_t j = d == 0 ? firstDesign : 1 - firstDesign;
+      naja::DNL::DNLFull& dnl = designs.switchTo(handles[j]);
+      const auto& PIs = j == 0 ? PIs0 : PIs1;
+      const auto& outputs = j == 0 ? outputs0 : outputs1;
+      for (size_t k = 0; k < failedPOs_.size(); ++k) {
+        const size_t i = failedPOs_[k];
+        OutputCone& outputCone = cones[k][j];
+        auto counterexample = counterexamples.find(i);
+        if (counterexample != counterexamples.end()) {
+          // Replay on the truth-table tree of the output, independently of
+          // the AIG the counterexample comes from. Inputs the counterexample
+          // leaves free get the same random word on both sides, so the 64
+          // lanes check that it forces the difference.
+          SNLLogicCloud cloud(outputs[i], PIs, outputs);
+          cloud.compute();
+          cloud.getTruthTable().finalize();
+          const CompiledTruthTableTree tree(
+              cloud.getTruthTable(),
+              (j == 0 ? builder0 : builder1).getInputVarIDs());
+          std::vector<uint64_t> inputs(tree.getNumInputs());
+          for (size_t row = 0; row < inputs.size(); ++row) {
+            inputs[row] = BoolExprSimulator::inputWord(
+                BoolExprSimulator::kDefaultSeed, row + 2, 0);
           }
-          SNLLogicCone cone(j == 0 ? outputs0[i] : outputs1[i], PIs[j],
-                            &dnls_[j]);
-          cone.run();
-          // std::string dotFileNameEquis(
-          //     std::string(prefix_ + "_" +
-          //     DNL::get()->getDNLTerminalFromID(outputs0[i]).getSnlBitTerm()->getName().getString()
-          //     + std::to_string(outputs0[i]) + "_" +std::to_string(j) +
-          //     std::string(".dot")));
-          // std::string svgFileNameEquis(
-          //     std::string(prefix_ + "_" +
-          //     DNL::get()->getDNLTerminalFromID(outputs0[i]).getSnlBitTerm()->getName().getString()
-          //     + std::to_string(outputs0[i]) + "_" + std::to_string(j) +
-          //     std::string(".svg")));
-          // SnlVisualiser snl2(topModels[j], cone.getEquipotentials());
-          for (const auto& equi : cone.getEquipotentials()) {
-            for (const auto& term : equi.getTerms()) {
-              if (j == 0) {
-                terms0.insert(term);
-                // logger->info("$$$ Term 0: {}", term->getString().c_str());
-              } else {
-                terms1.insert(term);
-                // logger->info("### Term 1: {}", term->getString().c_str());
-              }
-            }
-            for (const auto& termOcc : equi.getInstTermOccurrences()) {
-              if (j == 0) {
-                insTerms0.insert(termOcc);
-                // logger->info("$$$ Inst Term 0: {}",
-                // termOcc.getString().c_str());
-              } else {
-                insTerms1.insert(termOcc);
-                // logger->info("### Inst Term 1: {}",
-                // termOcc.getString().c_str());
-              }
+          for (const auto& [varId, value] : counterexample->second) {
+            if (varId >= 2 && varId - 2 < inputs.size()) {
+              inputs[varId - 2] = value ? ~uint64_t{0} : 0;
             }
           }
-          // snl2.process();
-          // snl2.getNetlistGraph().dumpDotFile(dotFileNameEquis.c_str());
-          // executeCommand(std::string(std::string("dot -Tsvg ") +
-          //                            dotFileNameEquis + std::string(" -o ") +
-          //                            svgFileNameEquis).c_str());
-          // logger->info("svg file name: {}", svgFileNameEquis);
+          tree.evaluate(inputs.data(), 1, &outputCone.replayWord);
+          cloud.destroy();
         }
-
-        // find intersection and diff of terms0 and terms1
-        naja::NL::SNLEquipotential::Terms termsCommon;
-        naja::NL::SNLEquipotential::Terms termsDiff;
-        for (const auto& term0 : terms0) {
-          bool found = false;
-          for (const auto& term1 : terms1) {
-            if (term0->getID() == term1->getID() &&
-                term0->getBit() == term1->getBit()) {
-              found = true;
-              break;
-            }
+        SNLLogicCone cone(outputs[i], PIs, &dnl);
+        cone.run();
+        // SnlVisualiser snl2(j == 0 ? top0_ : top1_, cone.getEquipotentials());
+        for (const auto& equi : cone.getEquipotentials()) {
+          for (const auto& term : equi.getTerms()) {
+            outputCone.terms.insert(term);
           }
-          if (found) {
-            termsCommon.insert(term0);
-          } else {
-            termsDiff.insert(term0);
-            if (term0->getDirection() ==
-                naja::NL::SNLBitTerm::Direction::Output) {
-              continue;
-            }
-            logger->info("Diff 0 term: {}", term0->getString());
+          for (const auto& termOcc : equi.getInstTermOccurrences()) {
+            outputCone.insTerms.insert(termOcc);
           }
         }
+      }
+    }
+
+    for (size_t k = 0; k < failedPOs_.size(); ++k) {
+      const size_t i = failedPOs_[k];
+      logger->info("Found difference for PO: {}", i);
+      // print path of index i
+      auto path0 = builder0.getOutputs2OutputsIDs().at(builder0.getDNLIDforOutput(i));
+      std::string pathString = "";
+      for (const auto& name : path0.first) {
+        pathString += name.getString() + ".";
+      }
+      for (const auto& id : path0.second) {
+        pathString += std::to_string(id) + ".";
+      }
+      logger->info("Path of differing PO {}: {}", i, pathString);
+      auto path1 = builder1.getOutputs2OutputsIDs().at(builder1.getDNLIDforOutput(i));
+      std::string pathString1 = "";
+      for (const auto& name : path1.first) {
+        pathString1 += name.getString() + ".";
+      }
+      for (const auto& id : path1.second) {
+        pathString1 += std::to_string(id) + ".";
+      }
+      logger->info("Path of differing PO {}: {}", i, pathString1);
+      const auto& terms0 = cones[k][0].terms;
+      const auto& terms1 = cones[k][1].terms;
+      const auto& insTerms0 = cones[k][0].insTerms;
+      const auto& insTerms1 = cones[k][1].insTerms;
+      auto counterexample = counterexamples.find(i);
+      const uint64_t replayWords[2] = {cones[k][0].replayWord,
+                                       cones[k][1].replayWord};
+
+      if (counterexample != counterexamples.end()) {
+        if ((replayWords[0] ^ replayWords[1]) == ~uint64_t{0}) {
+          logger->info("Counterexample for PO {} replays: {} vs {}", i,
+                       replayWords[0] & 1, replayWords[1] & 1);
+        } else {
+          // LCOV_EXCL_START
+          logger->warn("Counterexample for PO {} does not replay on the "
+                       "truth-table trees",
+                       i);
+          // LCOV_EXCL_STOP
+        }
+      }
+
+      // find intersection and diff of terms0 and terms1
+      naja::NL::SNLEquipotential::Terms termsCommon;
+      naja::NL::SNLEquipotential::Terms termsDiff;
+      for (const auto& term0 : terms0) {
+        bool found = false;
         for (const auto& term1 : terms1) {
-          bool found = false;
-          for (const auto& term0 : terms0) {
-            if (term0->getID() == term1->getID() &&
-                term0->getBit() == term1->getBit()) {
-              found = true;
-              break;
-            }
+          if (term0->getID() == term1->getID() &&
+              term0->getBit() == term1->getBit()) {
+            found = true;
+            break;
           }
-          if (!found) {
-            termsDiff.insert(term1);
-            if (term1->getDirection() ==
-                naja::NL::SNLBitTerm::Direction::Output) {
-              continue;
-            }
-            logger->info("Diff 1 term: {}", term1->getString());
+        }
+        if (found) {
+          termsCommon.insert(term0);
+        } else {
+          termsDiff.insert(term0);
+          if (term0->getDirection() ==
+              naja::NL::SNLBitTerm::Direction::Output) {
+            continue;
           }
+          logger->info("Diff 0 term: {}", term0->getString());
         }
-        // print termsDiff
-        // for (const auto& term : termsDiff) {
-        //   if (term->getDirection() ==
-        //   naja::NL::SNLBitTerm::Direction::Output) {
-        //     continue;
-        //   }
-        //   logger->info("Diff term: {}", term->getString());
-        // }
-        // find intersection and diff of insTerms0 and insTerms1
-        naja::NL::SNLEquipotential::InstTermOccurrences insTermsCommon;
-        naja::NL::SNLEquipotential::InstTermOccurrences insTermsDiff;
-        for (const auto& term0 : insTerms0) {
-          bool found = false;
-          for (const auto& term1 : insTerms1) {
-            if (term0.getPath().getPathNames() == term1.getPath().getPathNames() &&
-                term0.getInstTerm()->getInstance()->getName() ==
-                    term1.getInstTerm()->getInstance()->getName() &&
-                term0.getInstTerm()->getBitTerm()->getID() ==
-                    term1.getInstTerm()->getBitTerm()->getID() &&
-                term0.getInstTerm()->getBitTerm()->getBit() ==
-                    term1.getInstTerm()->getBitTerm()->getBit()) {
-              found = true;
-              break;
-            }
+      }
+      for (const auto& term1 : terms1) {
+        bool found = false;
+        for (const auto& term0 : terms0) {
+          if (term0->getID() == term1->getID() &&
+              term0->getBit() == term1->getBit()) {
+            found = true;
+            break;
           }
-          if (found) {
-            insTermsCommon.insert(term0);
-          } else {
-            insTermsDiff.insert(term0);
-            if (term0.getInstTerm()->getDirection() ==
-                    naja::NL::SNLInstTerm::Direction::Input ||
-                !term0.getInstTerm()
-                     ->getInstance()
-                     ->getModel()
-                     ->getInstances()
-                     .empty()) {
-              continue;
-            }
-            logger->info("Diff 0 inst term {} with direction {}",
-                         term0.getString(),
-                         term0.getInstTerm()->getDirection().getString());
+        }
+        if (!found) {
+          termsDiff.insert(term1);
+          if (term1->getDirection() ==
+              naja::NL::SNLBitTerm::Direction::Output) {
+            continue;
           }
+          logger->info("Diff 1 term: {}", term1->getString());
         }
+      }
+      // print termsDiff
+      // for (const auto& term : termsDiff) {
+      //   if (term->getDirection() ==
+      //   naja::NL::SNLBitTerm::Direction::Output) {
+      //     continue;
+      //   }
+      //   logger->info("Diff term: {}", term->getString());
+      // }
+      // find intersection and diff of insTerms0 and insTerms1
+      naja::NL::SNLEquipotential::InstTermOccurrences insTermsCommon;
+      naja::NL::SNLEquipotential::InstTermOccurrences insTermsDiff;
+      for (const auto& term0 : insTerms0) {
+        bool found = false;
         for (const auto& term1 : insTerms1) {
-          bool found = false;
-          for (const auto& term0 : insTerms0) {
-            if (term0.getPath().getPathNames() == term1.getPath().getPathNames() &&
-                term0.getInstTerm()->getInstance()->getName() ==
-                    term1.getInstTerm()->getInstance()->getName() &&
-                term0.getInstTerm()->getBitTerm()->getID() ==
-                    term1.getInstTerm()->getBitTerm()->getID() &&
-                term0.getInstTerm()->getBitTerm()->getBit() ==
-                    term1.getInstTerm()->getBitTerm()->getBit()) {
-              found = true;
-              break;
-            }
+          if (term0.getPath().getPathNames() == term1.getPath().getPathNames() &&
+              term0.getInstTerm()->getInstance()->getName() ==
+                  term1.getInstTerm()->getInstance()->getName() &&
+              term0.getInstTerm()->getBitTerm()->getID() ==
+                  term1.getInstTerm()->getBitTerm()->getID() &&
+              term0.getInstTerm()->getBitTerm()->getBit() ==
+                  term1.getInstTerm()->getBitTerm()->getBit()) {
+            found = true;
+            break;
           }
-          if (!found) {
-            insTermsDiff.insert(term1);
-            if (term1.getInstTerm()->getDirection() ==
-                    naja::NL::SNLInstTerm::Direction::Input ||
-                !term1.getInstTerm()
-                     ->getInstance()
-                     ->getModel()
-                     ->getInstances()
-                     .empty()) {
-              continue;
-            }
-            logger->info("Diff 1 inst term {} with direction {}",
-                         term1.getString(),
-                         term1.getInstTerm()->getDirection().getString());
+        }
+        if (found) {
+          insTermsCommon.insert(term0);
+        } else {
+          insTermsDiff.insert(term0);
+          if (term0.getInstTerm()->getDirection() ==
+                  naja::NL::SNLInstTerm::Direction::Input ||
+              !term0.getInstTerm()
+                   ->getInstance()
+                   ->getModel()
+                   ->getInstances()
+                   .empty()) {
+            continue;
           }
+          logger->info("Diff 0 inst term {} with direction {}",
+                       term0.getString(),
+                       term0.getInstTerm()->getDirection().getString());
+        }
+      }
+      for (const auto& term1 : insTerms1) {
+        bool found = false;
+        for (const auto& term0 : insTerms0) {
+          if (term0.getPath().getPathNames() == term1.getPath().getPathNames() &&
+              term0.getInstTerm()->getInstance()->getName() ==
+                  term1.getInstTerm()->getInstance()->getName() &&
+              term0.getInstTerm()->getBitTerm()->getID() ==
+                  term1.getInstTerm()->getBitTerm()->getID() &&
+              term0.getInstTerm()->getBitTerm()->getBit() ==
+                  term1.getInstTerm()->getBitTerm()->getBit()) {
+            found = true;
+            break;
+          }
+        }
+        if (!found) {
+          insTermsDiff.insert(term1);
+          if (term1.getInstTerm()->getDirection() ==
+                  naja::NL::SNLInstTerm::Direction::Input ||
+              !term1.getInstTerm()
+                   ->getInstance()
+                   ->getModel()
+                   ->getInstances()
+                   .empty()) {
+            continue;
+          }
+          logger->info("Diff 1 inst term {} with direction {}",
+                       term1.getString(),
+                       term1.getInstTerm()->getDirection().getString());
         }
-
-        logger->debug("size of intersection of terms: {}", termsCommon.size());
-        logger->debug("size of diff of terms: {}", termsDiff.size());
-        logger->debug("size of intersection of inst terms: {}",
-                      insTermsCommon.size());
-        logger->debug("size of diff of inst terms: {}", insTermsDiff.size());
       }
+
+      logger->debug("size of intersection of terms: {}", termsCommon.size());
+      logger->debug("size of diff of terms: {}", termsDiff.size());
+      logger->debug("size of intersection of inst terms: {}",
+                    insTermsCommon.size());
+      logger->debug("size of diff of inst terms: {}", insTermsDiff.size());
     }
   }
-  if (topInit_ != nullptr) {
-    univ->setTopDesign(topInit_);
+  if (!resultCacheFile_.empty()) {
+    std::vector<char> failed(numPairs, 0);
+    for (size_t i : failedPOs_) {
+      failed[i] = 1;
+    }
+    for (size_t i = 0; i < numPairs; ++i) {
+      resultCache.set(outputKeys[i],
+                      {coneHashes0[i], coneHashes1[i],
+                       failed[i]      ? MiterResultCache::Verdict::Different
+                       : undecided[i] ? MiterResultCache::Verdict::Undecided
+                                      : MiterResultCache::Verdict::Equivalent});
+    }
+    if (!resultCache.save(resultCacheFile_)) {
+      logger->warn("Could not write result cache {}", resultCacheFile_);
+    }
   }
   // if UNSAT → miter can never be true → outputs identical
-  logger->info("Circuits are {}", sat ? "DIFFERENT" : "IDENTICAL");
-  return !sat;
+  if (sat) {
+    logger->info("Circuits are DIFFERENT");
+  } else if (!undecidedPOs_.empty()) {
+    logger->warn("Circuits are UNDECIDED: {} outputs out of the solver limits",
+                 undecidedPOs_.size());
+  } else {
+    logger->info("Circuits are IDENTICAL");
+  }
+  return !sat && undecidedPOs_.empty();
 }
 
-std::shared_ptr<BoolExpr> MiterStrategy::buildMiter(
-    const tbb::concurrent_vector<std::shared_ptr<BoolExpr>>& A,
-    const tbb::concurrent_vector<std::shared_ptr<BoolExpr>>& B) const {
+std::vector<AIG::Lit> MiterStrategy::buildMiters(
+    AIG& aig,
+    const std::vector<AIG::Lit>& A,
+    const std::vector<AIG::Lit>& B,
+    std::vector<std::vector<size_t>>& clusters) const {
   ensureLoggerInitialized();
-  logger->debug("buildMiter: A.size={} B.size={}", A.size(), B.size());
+  logger->debug("buildMiters: A.size={} B.size={}", A.size(), B.size());
 
   // Empty miter = always-false (no outputs to compare)
   if (A.empty()) {
-    logger->error("buildMiter called with empty A");
+    logger->error("buildMiters called with empty A");
     assert(false);
-    return BoolExpr::createFalse();
+    return {};
+  }
+  if (A.size() != B.size()) {
+    logger->warn("Miter different number of outputs: {} vs {}", A.size(),
+                 B.size());
   }
 
-  // Start with the first XOR
-  auto miter = BoolExpr::Xor(A[0], B[0]);
-
-  // OR in the rest
-  for (size_t i = 1; i < A.size(); ++i) {
-    if (B.size() <= i) {
-      logger->warn("Miter different number of outputs: {} vs {}", A.size(),
-                   B.size());
-      break;
+  std::vector<AIG::Lit> xors;
+  for (size_t i = 0; i < std::min(A.size(), B.size()); ++i) {
+    xors.push_back(aig.createXor(A[i], B[i]));
+  }
+  // A balanced OR per part keeps the miter log-deep and lays out the pairs
+  // that share logic next to each other in the solver.
+  clusters = partitionBySupport(aig, xors, partitionSupport_);
+  std::vector<AIG::Lit> miters;
+  miters.reserve(clusters.size());
+  for (const auto& cluster : clusters) {
+    std::vector<AIG::Lit> lits;
+    lits.reserve(cluster.size());
+    for (size_t i : cluster) {
+      lits.push_back(xors[i]);
     }
-    auto diff = BoolExpr::Xor(A[i], B[i]);
-    miter = BoolExpr::Or(miter, diff);
+    miters.push_back(createBalancedOr(aig, std::move(lits)));
   }
-  // logger->trace("buildMiter produced expression: {}", miter->toString());
-  return miter;
+  logger->info("Miter: {} output pairs in {} support clusters", xors.size(),
+               clusters.size());
+  return miters;
 }
@@ -2,8 +2,10 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
 #include <vector>
+#include "AIG.h"
 #include "BoolExpr.h"
 #include "DNL.h"
+#include "SolveBudget.h"
 #include <tbb/concurrent_vector.h>
 
 #pragma once
@@ -22,6 +24,39 @@ class MiterStrategy {
 
   bool run();
 
+  // Persistent per-output verdicts (MiterResultCache); empty disables it
+  void setResultCacheFile(const std::string& path) { resultCacheFile_ = path; }
+
+  // Merge internal equivalences (AIGSweeper) before the output checks
+  void setSATSweeping(bool enable) { satSweeping_ = enable; }
+
+  // Solve output clusters with disjoint supports as separate miters
+  void setClusteredMiters(bool enable) { clusteredMiters_ = enable; }
+
+  // Clusters reading more inputs are split into parts of at most that many
+  // inputs, which may overlap (partitionBySupport); 0 keeps whole clusters
+  void setPartitionSupport(size_t maxSupport) {
+    partitionSupport_ = maxSupport;
+  }
+  static constexpr size_t kDefaultPartitionSupport = 2048;
+
+  // Minimized counterexamples of the differing outputs (MiterStimulus);
+  // empty only logs them
+  void setCounterexampleFile(const std::string& path) {
+    counterexampleFile_ = path;
+  }
+
+  // Stimulus file evaluated on both designs before the checks
+  void setReplayFile(const std::string& path) { replayFile_ = path; }
+
+  // Conflict, propagation and time limits of the SAT checks; outputs still
+  // out of them after the escalations are reported undecided
+  void setSolverLimits(const SolverLimits& limits) { solverLimits_ = limits; }
+
+  // Outputs found different and left undecided by the last run
+  size_t getNumDifferent() const { return failedPOs_.size(); }
+  size_t getNumUndecided() const { return undecidedPOs_.size(); }
+
   void normalizeInputs(std::vector<naja::DNL::DNLID>& inputs0,
                        std::vector<naja::DNL::DNLID>& inputs1,
                         const std::map<std::pair<std::vector<NLName>, std::vector<NLID::DesignObjectID>>, naja::DNL::DNLID>& inputs0Map,
@@ -34,19 +69,31 @@ class MiterStrategy {
   
   static std::string logFileName_;
  private:
-  std::shared_ptr<BoolExpr> buildMiter(
-      const tbb::concurrent_vector<std::shared_ptr<BoolExpr>>& A,
-      const tbb::concurrent_vector<std::shared_ptr<BoolExpr>>& B) const;
+  bool runInArena();
+
+  // One miter per part of the output pairs (partitionBySupport), each a
+  // balanced OR of the pair XORs; clusters receives the pair indices.
+  std::vector<AIG::Lit> buildMiters(
+      AIG& aig,
+      const std::vector<AIG::Lit>& A,
+      const std::vector<AIG::Lit>& B,
+      std::vector<std::vector<size_t>>& clusters) const;
   
   static naja::NL::SNLDesign* top0_;
   static naja::NL::SNLDesign* top1_;
   tbb::concurrent_vector<BoolExpr> POs0_;
   tbb::concurrent_vector<BoolExpr> POs1_;
-  std::vector<naja::DNL::DNLID> failedPOs_;
+  tbb::concurrent_vector<naja::DNL::DNLID> failedPOs_;
+  tbb::concurrent_vector<naja::DNL::DNLID> undecidedPOs_;
   BoolExpr miterClause_;
   std::string prefix_;
-  naja::NL::SNLDesign* topInit_ = nullptr;
-  std::vector<naja::DNL::DNLFull> dnls_;
+  std::string resultCacheFile_;
+  std::string counterexampleFile_;
+  std::string replayFile_;
+  bool satSweeping_ = true;
+  bool clusteredMiters_ = true;
+  size_t partitionSupport_ = kDefaultPartitionSupport;
+  SolverLimits solverLimits_;
 };
 
 }  // namespace KEPLER_FORMAL
\ No newline at end of file
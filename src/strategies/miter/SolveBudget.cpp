@@ -0,0 +1,155 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "SolveBudget.h"
+#include <algorithm>
+#include <condition_variable>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+
+using namespace KEPLER_FORMAL;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+Clock::time_point after(double seconds) {
+  return Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                            std::chrono::duration<double>(seconds));
+}
+
+int64_t scale(int64_t limit) {
+  constexpr int64_t kMax = std::numeric_limits<int64_t>::max();
+  if (limit < 0) return limit;
+  return limit > kMax / SolverLimits::kEscalationFactor
+             ? kMax
+             : limit * SolverLimits::kEscalationFactor;
+}
+
+}  // namespace
+
+// Interrupts the armed solvers whose deadline has passed. Interrupts are
+// sent under the lock, so once disarm() returns the solver gets no more.
+class SolveBudget::Watchdog {
+ public:
+  using Timers = std::multimap<Clock::time_point, Glucose::SimpSolver*>;
+
+  Watchdog() : thread_([this] { run(); }) {}
+  ~Watchdog() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    wakeup_.notify_one();
+    thread_.join();
+  }
+
+  Timers::iterator arm(Glucose::SimpSolver& S, Clock::time_point deadline) {
+    Timers::iterator timer;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      timer = timers_.emplace(deadline, &S);
+    }
+    wakeup_.notify_one();
+    return timer;
+  }
+
+  void disarm(Glucose::SimpSolver& S, Timers::iterator timer) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fired_.erase(&S) == 0) {
+      timers_.erase(timer);
+    }
+  }
+
+ private:
+  void run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+      if (timers_.empty()) {
+        wakeup_.wait(lock);
+        continue;
+      }
+      auto first = timers_.begin();
+      if (Clock::now() < first->first) {
+        wakeup_.wait_until(lock, first->first);
+        continue;
+      }
+      first->second->interrupt();
+      fired_.insert(first->second);
+      timers_.erase(first);
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable wakeup_;
+  Timers timers_;
+  // solvers interrupted and not disarmed yet; a solver is armed once at most
+  std::set<Glucose::SimpSolver*> fired_;
+  bool stop_ = false;
+  std::thread thread_;
+};
+
+SolverLimits SolverLimits::escalate(unsigned level) const {
+  SolverLimits limits = *this;
+  for (unsigned l = 0; l < level; ++l) {
+    limits.conflicts = scale(limits.conflicts);
+    limits.propagations = scale(limits.propagations);
+    limits.seconds *= kEscalationFactor;
+  }
+  return limits;
+}
+
+SolveBudget::SolveBudget(const SolverLimits& limits)
+    : limits_(limits),
+      deadline_(limits.totalSeconds > 0 ? after(limits.totalSeconds)
+                                        : Clock::time_point::max()) {
+  if (limits.seconds > 0 || limits.totalSeconds > 0) {
+    watchdog_ = std::make_unique<Watchdog>();
+  }
+}
+
+SolveBudget::~SolveBudget() = default;
+
+bool SolveBudget::isExhausted() const {
+  return deadline_ != Clock::time_point::max() && Clock::now() >= deadline_;
+}
+
+Glucose::lbool SolveBudget::solve(Glucose::SimpSolver& S,
+                                  const Glucose::vec<Glucose::Lit>& assumps,
+                                  bool doSimp,
+                                  unsigned level,
+                                  int64_t maxConflicts) const {
+  if (isExhausted()) {
+    return l_Undef;
+  }
+  const SolverLimits limits = limits_.escalate(level);
+  int64_t conflicts = limits.conflicts;
+  if (maxConflicts >= 0) {
+    conflicts = conflicts < 0 ? maxConflicts : std::min(conflicts, maxConflicts);
+  }
+  S.budgetOff();
+  if (conflicts >= 0) {
+    S.setConfBudget(conflicts);
+  }
+  if (limits.propagations >= 0) {
+    S.setPropBudget(limits.propagations);
+  }
+  Clock::time_point deadline = deadline_;
+  if (limits.seconds > 0) {
+    deadline = std::min(deadline, after(limits.seconds));
+  }
+  Glucose::lbool result = l_Undef;
+  if (deadline == Clock::time_point::max()) {
+    result = S.solveLimited(assumps, doSimp);
+  } else {
+    auto timer = watchdog_->arm(S, deadline);
+    result = S.solveLimited(assumps, doSimp);
+    watchdog_->disarm(S, timer);
+    S.clearInterrupt();
+  }
+  S.budgetOff();
+  return result;
+}
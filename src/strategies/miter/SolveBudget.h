@@ -0,0 +1,70 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include "core/SolverTypes.h"
+#include "simp/SimpSolver.h"
+
+namespace KEPLER_FORMAL {
+
+/// Resource limits of the SAT checks of a miter run. Per-check limits apply
+/// to one solve call; the total time covers every check of the run.
+struct SolverLimits {
+  int64_t conflicts = -1;     // per check, negative for no limit
+  int64_t propagations = -1;  // per check, negative for no limit
+  double seconds = 0;         // per check, 0 for no limit
+  double totalSeconds = 0;    // whole run, 0 for no limit
+  // Retries of an undecided output, each with kEscalationFactor times the
+  // per-check limits of the previous one
+  unsigned escalations = 2;
+
+  static constexpr int64_t kEscalationFactor = 8;
+
+  // Per-check limits of escalation `level`, 0 being these
+  SolverLimits escalate(unsigned level) const;
+};
+
+/// Runs solve calls within SolverLimits.
+///
+/// Conflict and propagation limits map to the Glucose budgets. Glucose has
+/// no time budget: with a time limit, a watchdog thread interrupts the
+/// solver once the time of the check or of the run is over, simplification
+/// included. A call that runs out of any limit returns l_Undef, and once the
+/// total time is spent every call does so without solving. solve() may be
+/// called concurrently on distinct solvers.
+class SolveBudget {
+ public:
+  // The total time runs from construction
+  explicit SolveBudget(const SolverLimits& limits);
+  ~SolveBudget();
+
+  const SolverLimits& getLimits() const { return limits_; }
+
+  // maxConflicts, when not negative, tightens the conflict limit of the call
+  Glucose::lbool solve(Glucose::SimpSolver& S,
+                       const Glucose::vec<Glucose::Lit>& assumps,
+                       bool doSimp = true,
+                       unsigned level = 0,
+                       int64_t maxConflicts = -1) const;
+
+  // True once the total time is spent
+  bool isExhausted() const;
+  // End of the total time, time_point::max() without a limit
+  std::chrono::steady_clock::time_point getDeadline() const {
+    return deadline_;
+  }
+
+ private:
+  class Watchdog;
+
+  SolverLimits limits_;
+  std::chrono::steady_clock::time_point deadline_;
+  std::unique_ptr<Watchdog> watchdog_;  // nullptr without time limits
+};
+
+}  // namespace KEPLER_FORMAL
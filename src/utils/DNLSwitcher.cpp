@@ -0,0 +1,47 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "DNLSwitcher.h"
+#include <cassert>
+#include "NLUniverse.h"
+#include "PerfReport.h"
+
+using namespace KEPLER_FORMAL;
+using namespace naja::NL;
+
+DNLSwitcher::DNLSwitcher() {
+  initialTop_ = NLUniverse::get()->getTopDesign();
+  // A DNL left by a previous owner may belong to any design
+  naja::DNL::destroy();
+}
+
+DNLSwitcher::~DNLSwitcher() {
+  naja::DNL::destroy();
+  if (initialTop_ != nullptr) {
+    NLUniverse::get()->setTopDesign(initialTop_);
+  }
+}
+
+DNLSwitcher::Handle DNLSwitcher::add(SNLDesign* top) {
+  tops_.push_back(top);
+  return tops_.size() - 1;
+}
+
+naja::DNL::DNLFull& DNLSwitcher::switchTo(Handle design) {
+  assert(design < tops_.size());
+  if (design == current_) {
+    return *naja::DNL::get();
+  }
+  PerfReport::Phase phase("dnl");
+  naja::DNL::destroy();
+  NLUniverse::get()->setTopDesign(tops_[design]);
+  naja::DNL::DNLFull& dnl = *naja::DNL::get();
+  current_ = design;
+  ++numBuilds_;
+  phase.add("design", design).add("terms", dnl.getNBterms());
+  return dnl;
+}
+
+std::unique_ptr<naja::DNL::DNLFull> DNLSwitcher::copy(Handle design) {
+  return std::make_unique<naja::DNL::DNLFull>(switchTo(design));
+}
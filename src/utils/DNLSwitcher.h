@@ -0,0 +1,62 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <vector>
+#include "DNL.h"
+
+namespace naja {
+namespace NL {
+class SNLDesign;
+}
+}  // namespace naja
+
+namespace KEPLER_FORMAL {
+
+/// Switches the process DNL between the designs of a run.
+///
+/// Naja keeps a single DNL per process, the one of the universe top design,
+/// and its terminal and instance accessors resolve through it, so the
+/// designs cannot keep live DNLs side by side. switchTo() makes a design the
+/// top and rebuilds the DNL for it; nothing is cached across switches, and
+/// callers group their work per design to switch as rarely as possible.
+/// Switching to the current design again is free. Nothing else may destroy
+/// the DNL while a switcher is alive. The destructor releases the DNL and
+/// restores the top design the universe had.
+class DNLSwitcher {
+ public:
+  using Handle = size_t;
+  static constexpr Handle kNoDesign = std::numeric_limits<Handle>::max();
+
+  DNLSwitcher();
+  ~DNLSwitcher();
+  DNLSwitcher(const DNLSwitcher&) = delete;
+  DNLSwitcher& operator=(const DNLSwitcher&) = delete;
+
+  Handle add(naja::NL::SNLDesign* top);
+
+  // DNL of the design, rebuilt unless the design is the current one
+  naja::DNL::DNLFull& switchTo(Handle design);
+  Handle getCurrent() const { return current_; }
+
+  // Copy of the DNL of the design that stays valid after a switch to another
+  // design. Accessors that resolve through the current DNL
+  // (DNLTerminalFull::getDNLInstance(), isTopPort()...) must not be used on
+  // it; SNLLogicDAG only reads its tables.
+  std::unique_ptr<naja::DNL::DNLFull> copy(Handle design);
+
+  // DNL constructions since the context was created
+  size_t getNumBuilds() const { return numBuilds_; }
+
+ private:
+  std::vector<naja::NL::SNLDesign*> tops_;
+  naja::NL::SNLDesign* initialTop_ = nullptr;
+  Handle current_ = kNoDesign;
+  size_t numBuilds_ = 0;
+};
+
+}  // namespace KEPLER_FORMAL
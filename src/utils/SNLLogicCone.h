@@ -13,19 +13,19 @@ class SNLEquipotential;
 
 namespace KEPLER_FORMAL {
 
+// Cone of a term on the DNL of the current top design, which must be the
+// one passed in (see DNLSwitcher); the DNL is neither rebuilt nor destroyed.
 class SNLLogicCone {
  public:
   SNLLogicCone(naja::DNL::DNLID seedOutputTerm,
                std::vector<naja::DNL::DNLID> pis)
       : seedOutputTerm_(seedOutputTerm), PIs_(pis) {
-    naja::DNL::destroy();
     dnl_ = naja::DNL::get();
   }
   SNLLogicCone(naja::DNL::DNLID seedOutputTerm,
                std::vector<naja::DNL::DNLID> pis,
                naja::DNL::DNLFull* dnl)
       : seedOutputTerm_(seedOutputTerm), PIs_(pis) {
-    naja::DNL::destroy();
     dnl_ = dnl;
   }
   void run();
@@ -0,0 +1,101 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "AIG.h"
+#include "BoolExpr.h"
+#include "BoolExprSimulator.h"
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+using namespace KEPLER_FORMAL;
+
+//------------------------------------------------------------------------------
+// AIG construction
+//------------------------------------------------------------------------------
+
+TEST(AIGTest, ConstantsAndInputs) {
+  AIG aig;
+  EXPECT_EQ(aig.createInput(0), AIG::kFalse);
+  EXPECT_EQ(aig.createInput(1), AIG::kTrue);
+  AIG::Lit a = aig.createInput(2);
+  EXPECT_EQ(aig.createInput(2), a);
+  EXPECT_TRUE(aig.isInput(AIG::getNode(a)));
+  EXPECT_EQ(aig.getInputVarId(AIG::getNode(a)), 2u);
+  EXPECT_EQ(aig.getNumInputs(), 1u);
+  EXPECT_EQ(aig.getNumAnds(), 0u);
+}
+
+TEST(AIGTest, FoldingAndStrash) {
+  AIG aig;
+  AIG::Lit a = aig.createInput(2);
+  AIG::Lit b = aig.createInput(3);
+  EXPECT_EQ(aig.createAnd(a, AIG::kFalse), AIG::kFalse);
+  EXPECT_EQ(aig.createAnd(a, AIG::kTrue), a);
+  EXPECT_EQ(aig.createAnd(a, a), a);
+  EXPECT_EQ(aig.createAnd(a, AIG::negate(a)), AIG::kFalse);
+  EXPECT_EQ(aig.createOr(a, AIG::negate(a)), AIG::kTrue);
+  EXPECT_EQ(aig.createXor(a, a), AIG::kFalse);
+  EXPECT_EQ(aig.getNumAnds(), 0u);
+
+  AIG::Lit ab = aig.createAnd(a, b);
+  EXPECT_EQ(aig.createAnd(b, a), ab);
+  EXPECT_EQ(aig.getNumAnds(), 1u);
+  EXPECT_TRUE(aig.isAnd(AIG::getNode(ab)));
+}
+
+TEST(AIGTest, BoolExprRoundTrip) {
+  auto a = BoolExpr::Var(2);
+  auto b = BoolExpr::Var(3);
+  auto c = BoolExpr::Var(4);
+  auto e = BoolExpr::Xor(BoolExpr::Or(a, BoolExpr::Not(b)), BoolExpr::And(b, c));
+  AIG aig;
+  AIG::Lit lit = aig.importBoolExpr(e);
+  auto back = aig.toBoolExpr(lit);
+  for (unsigned m = 0; m < 8; ++m) {
+    std::unordered_map<size_t, bool> env{
+        {2, (m & 1) != 0}, {3, (m & 2) != 0}, {4, (m & 4) != 0}};
+    EXPECT_EQ(e->evaluate(env), back->evaluate(env));
+  }
+}
+
+TEST(AIGTest, AppendSharesInputsAndLogic) {
+  AIG g0;
+  AIG::Lit o0 = g0.createOr(g0.createInput(2), g0.createInput(3));
+  AIG g1;
+  // Same function, inputs created in another order
+  AIG::Lit b = g1.createInput(3);
+  AIG::Lit a = g1.createInput(2);
+  AIG::Lit o1 = g1.createOr(a, b);
+  size_t nodes = g0.getNumNodes();
+  auto map = g0.append(g1);
+  EXPECT_EQ(AIG::remapLit(map, o1), o0);
+  EXPECT_EQ(g0.getNumNodes(), nodes);
+}
+
+TEST(AIGTest, ParallelMerge) {
+  const size_t numParts = 7;
+  std::vector<AIG> parts(numParts);
+  std::vector<std::vector<AIG::Lit>> lits(numParts);
+  std::vector<std::shared_ptr<BoolExpr>> refs;
+  for (size_t p = 0; p < numParts; ++p) {
+    auto x = BoolExpr::Var(2 + p);
+    auto y = BoolExpr::Var(3 + p);
+    auto e = BoolExpr::Or(BoolExpr::And(x, y), BoolExpr::Var(2));
+    lits[p].push_back(parts[p].importBoolExpr(e));
+    refs.push_back(e);
+  }
+  AIG merged = AIG::merge(parts, lits);
+  BoolExprSimulator sim;
+  for (size_t p = 0; p < numParts; ++p) {
+    sim.addRoot(merged, lits[p][0]);
+    sim.addRoot(refs[p]);
+  }
+  sim.run(4);
+  for (size_t p = 0; p < numParts; ++p) {
+    EXPECT_EQ(sim.firstDifference(2 * p, 2 * p + 1), (size_t)-1);
+  }
+  EXPECT_EQ(merged.getNumInputs(), numParts + 1);
+}
@@ -0,0 +1,57 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <gtest/gtest.h>
+#include <tbb/parallel_for.h>
+#include <memory>
+#include "BoolExpr.h"
+#include "BoolExprCache.h"
+
+using namespace KEPLER_FORMAL;
+
+TEST(BoolExprCacheTests, LiveNodesAreSharedDeadOnesReleased) {
+  auto a = BoolExpr::Var(2);
+  auto b = BoolExpr::Var(3);
+  auto ab = BoolExpr::And(a, b);
+  EXPECT_EQ(ab, BoolExpr::And(b, a));
+  EXPECT_EQ(BoolExpr::Var(2), a);
+
+  std::weak_ptr<BoolExpr> weak = BoolExpr::Or(ab, BoolExpr::Var(4));
+  // Nothing references the OR node, the cache does not keep it
+  EXPECT_TRUE(weak.expired());
+  auto abc = BoolExpr::Or(ab, BoolExpr::Var(4));
+  EXPECT_TRUE(abc->getLeft() == ab || abc->getRight() == ab);
+  EXPECT_EQ(abc, BoolExpr::Or(BoolExpr::Var(4), ab));
+}
+
+TEST(BoolExprCacheTests, ExpiredEntriesAreSwept) {
+  BoolExprCache::destroy();
+  const size_t reclaimed = BoolExprCache::getNumReclaimed();
+  auto kept = BoolExpr::Xor(BoolExpr::Var(2), BoolExpr::Var(3));
+  constexpr size_t n = 200000;
+  for (size_t i = 0; i < n; ++i) {
+    BoolExpr::And(BoolExpr::Var(i + 10), BoolExpr::Not(BoolExpr::Var(2)));
+  }
+  EXPECT_GT(BoolExprCache::getNumReclaimed(), reclaimed);
+  EXPECT_LT(BoolExprCache::getNumEntries(), n);
+  // Sweeps keep the live entries
+  EXPECT_EQ(kept, BoolExpr::Xor(BoolExpr::Var(3), BoolExpr::Var(2)));
+  BoolExprCache::destroy();
+  EXPECT_EQ(BoolExprCache::getNumEntries(), 0u);
+}
+
+TEST(BoolExprCacheTests, ConcurrentLookupsAreCountedExactly) {
+  auto a = BoolExpr::Var(2);
+  auto b = BoolExpr::Var(3);
+  auto ab = BoolExpr::Or(a, b);
+  const size_t queries = BoolExprCache::getNumQueries();
+  const size_t hits = BoolExprCache::getNumHits();
+  const size_t frontHits = BoolExprCache::getNumFrontHits();
+  constexpr size_t n = 100000;
+  tbb::parallel_for(size_t{0}, n, [&](size_t) {
+    EXPECT_EQ(BoolExpr::Or(b, a), ab);
+  });
+  EXPECT_EQ(BoolExprCache::getNumQueries() - queries, n);
+  EXPECT_EQ(BoolExprCache::getNumHits() - hits, n);
+  EXPECT_GT(BoolExprCache::getNumFrontHits() - frontHits, 0u);
+}
@@ -0,0 +1,94 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "BoolExpr.h"
+#include "BoolExprSimulator.h"
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+using namespace KEPLER_FORMAL;
+
+//------------------------------------------------------------------------------
+// BoolExprSimulator
+//------------------------------------------------------------------------------
+
+TEST(BoolExprSimulatorTest, ConstantsAndVars) {
+  BoolExprSimulator sim;
+  size_t f = sim.addRoot(BoolExpr::createFalse());
+  size_t t = sim.addRoot(BoolExpr::createTrue());
+  size_t x = sim.addRoot(BoolExpr::Var(2));
+  sim.run(4);
+  for (size_t w = 0; w < sim.getNumWords(); ++w) {
+    EXPECT_EQ(sim.getSignature(f)[w], 0u);
+    EXPECT_EQ(sim.getSignature(t)[w], ~uint64_t(0));
+    EXPECT_EQ(sim.getSignature(x)[w], BoolExprSimulator::inputWord(
+                                          BoolExprSimulator::kDefaultSeed, 2, w));
+  }
+}
+
+TEST(BoolExprSimulatorTest, EquivalentExpressionsShareSignature) {
+  auto a = BoolExpr::Var(2);
+  auto b = BoolExpr::Var(3);
+  auto c = BoolExpr::Var(4);
+  // a & (b | c)  vs  (a & b) | (a & c)
+  auto lhs = BoolExpr::And(a, BoolExpr::Or(b, c));
+  auto rhs = BoolExpr::Or(BoolExpr::And(a, b), BoolExpr::And(a, c));
+  // a ^ b  vs  (a & !b) | (!a & b)
+  auto x0 = BoolExpr::Xor(a, b);
+  auto x1 = BoolExpr::Or(BoolExpr::And(a, BoolExpr::Not(b)),
+                         BoolExpr::And(BoolExpr::Not(a), b));
+  BoolExprSimulator sim;
+  size_t l = sim.addRoot(lhs);
+  size_t r = sim.addRoot(rhs);
+  size_t y0 = sim.addRoot(x0);
+  size_t y1 = sim.addRoot(x1);
+  sim.run(8);
+  EXPECT_EQ(sim.firstDifference(l, r), (size_t)-1);
+  EXPECT_EQ(sim.firstDifference(y0, y1), (size_t)-1);
+}
+
+TEST(BoolExprSimulatorTest, DifferenceComesWithWitness) {
+  auto a = BoolExpr::Var(2);
+  auto b = BoolExpr::Var(3);
+  auto e0 = BoolExpr::And(a, b);
+  auto e1 = BoolExpr::Or(a, b);
+  BoolExprSimulator sim;
+  size_t r0 = sim.addRoot(e0);
+  size_t r1 = sim.addRoot(e1);
+  sim.run(2);
+  size_t pattern = sim.firstDifference(r0, r1);
+  ASSERT_NE(pattern, (size_t)-1);
+
+  auto support = sim.getSupport({r0, r1});
+  ASSERT_EQ(support, (std::vector<size_t>{2, 3}));
+  std::unordered_map<size_t, bool> env;
+  for (size_t v : support) {
+    env[v] = sim.getInputValue(v, pattern);
+  }
+  EXPECT_NE(e0->evaluate(env), e1->evaluate(env));
+}
+
+TEST(BoolExprSimulatorTest, SignatureMatchesEvaluate) {
+  auto a = BoolExpr::Var(2);
+  auto b = BoolExpr::Var(3);
+  auto c = BoolExpr::Var(5);
+  auto e = BoolExpr::Xor(BoolExpr::Or(a, BoolExpr::Not(c)), BoolExpr::And(b, c));
+  BoolExprSimulator sim;
+  size_t r = sim.addRoot(e);
+  sim.run(1);
+  for (size_t p = 0; p < 64; ++p) {
+    std::unordered_map<size_t, bool> env;
+    for (size_t v : {2, 3, 5}) {
+      env[v] = sim.getInputValue(v, p);
+    }
+    EXPECT_EQ(((sim.getSignature(r)[0] >> p) & 1) != 0, e->evaluate(env));
+  }
+}
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
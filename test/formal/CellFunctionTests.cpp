@@ -0,0 +1,99 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "CellFunction.h"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+using namespace KEPLER_FORMAL;
+
+TEST(CellFunctionTest, InstancesSubstituteTheirInputs) {
+  // AOI21 = !((a & b) | c)
+  uint64_t aoi = 0;
+  for (uint64_t m = 0; m < 8; ++m) {
+    if (!(((m & 1) && ((m >> 1) & 1)) || ((m >> 2) & 1))) aoi |= uint64_t(1) << m;
+  }
+  const CellFunction function = CellFunction::compile(3, {aoi});
+  EXPECT_FALSE(function.isConstant);
+  EXPECT_EQ(function.support, (std::vector<uint32_t>{0, 1, 2}));
+  ASSERT_NE(function.cover, nullptr);
+
+  // Two instances on different inputs share the compiled form
+  AIG aig;
+  const std::vector<AIG::Lit> in0 = {aig.createInput(2), aig.createInput(3),
+                                     aig.createInput(4)};
+  const std::vector<AIG::Lit> in1 = {in0[2], in0[0], in0[1]};
+  const auto out0 = aig.toBoolExpr(function.instantiate(in0.data(), aig));
+  const auto out1 = aig.toBoolExpr(function.instantiate(in1.data(), aig));
+  const std::vector<std::shared_ptr<BoolExpr>> vars = {
+      BoolExpr::Var(2), BoolExpr::Var(3), BoolExpr::Var(4)};
+  const auto expr = function.instantiate(vars.data());
+  for (uint64_t m = 0; m < 8; ++m) {
+    std::unordered_map<size_t, bool> env{
+        {2, (m & 1) != 0}, {3, (m & 2) != 0}, {4, (m & 4) != 0}};
+    EXPECT_EQ(out0->evaluate(env), function.getBit(m));
+    EXPECT_EQ(expr->evaluate(env), function.getBit(m));
+    const uint64_t permuted = ((m >> 2) & 1) | ((m & 1) << 1) | (m & 2) << 1;
+    EXPECT_EQ(out1->evaluate(env), function.getBit(permuted));
+  }
+}
+
+TEST(CellFunctionTest, ConstantsAndSupport) {
+  const CellFunction one = CellFunction::compile(2, {0xF});
+  EXPECT_TRUE(one.isConstant);
+  EXPECT_TRUE(one.constantValue);
+  AIG aig;
+  EXPECT_EQ(one.instantiate(nullptr, aig), AIG::kTrue);
+  EXPECT_TRUE(CellFunction::compile(0, {0}).isConstant);
+
+  // !a whatever b
+  const CellFunction notA = CellFunction::compile(2, {0x5});
+  EXPECT_EQ(notA.support, (std::vector<uint32_t>{0}));
+}
+
+TEST(CellFunctionTest, WideTablesUseMinterms) {
+  // AND of more inputs than covers handle
+  const uint32_t k = TruthTableCoverCache::kMaxVars + 1;
+  std::vector<uint64_t> words((uint64_t{1} << k) / 64, 0);
+  words.back() = uint64_t{1} << 63;
+  const CellFunction function = CellFunction::compile(k, words);
+  EXPECT_EQ(function.cover, nullptr);
+  EXPECT_EQ(function.support.size(), k);
+
+  std::vector<std::shared_ptr<BoolExpr>> vars;
+  std::unordered_map<size_t, bool> env;
+  for (uint32_t j = 0; j < k; ++j) {
+    vars.push_back(BoolExpr::Var(j + 2));
+    env[j + 2] = true;
+  }
+  const auto expr = function.instantiate(vars.data());
+  EXPECT_TRUE(expr->evaluate(env));
+  env[5] = false;
+  EXPECT_FALSE(expr->evaluate(env));
+}
+
+TEST(CellFunctionTest, WideMintermsAreDistinctOverTheSupport) {
+  // XOR of inputs 0 and 1 of a table too wide for covers: every other input
+  // is ignored, so only the two on-set minterms of the support remain
+  const uint32_t k = TruthTableCoverCache::kMaxVars + 1;
+  std::vector<uint64_t> words((uint64_t{1} << k) / 64,
+                              0x6666666666666666ULL);
+  const CellFunction function = CellFunction::compile(k, words);
+  ASSERT_EQ(function.cover, nullptr);
+  EXPECT_EQ(function.support, (std::vector<uint32_t>{0, 1}));
+  EXPECT_EQ(function.minterms.size(), 2u);
+
+  AIG aig;
+  std::vector<AIG::Lit> inputs;
+  for (uint32_t j = 0; j < k; ++j) {
+    inputs.push_back(aig.createInput(j + 2));
+  }
+  const size_t before = aig.getNumAnds();
+  const AIG::Lit lit = function.instantiate(inputs.data(), aig);
+  // two minterms and their OR
+  EXPECT_EQ(aig.getNumAnds() - before, 3u);
+  EXPECT_EQ(lit, aig.createXor(inputs[0], inputs[1]));
+}
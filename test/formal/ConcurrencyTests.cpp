@@ -0,0 +1,40 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <gtest/gtest.h>
+#include <tbb/parallel_for.h>
+#include <atomic>
+#include <cstdlib>
+#include "Concurrency.h"
+
+using namespace KEPLER_FORMAL;
+
+TEST(ConcurrencyTests, ArenaFollowsTheThreadBudget) {
+  const bool sequential = getenv("KEPLER_NO_MT") != nullptr;
+  EXPECT_TRUE(Concurrency::configure(2));
+  EXPECT_EQ(Concurrency::getNumThreads(), sequential ? 1u : 2u);
+  EXPECT_EQ(Concurrency::isParallel(), !sequential);
+
+  // Work submitted through execute() stays within the budget
+  std::atomic<int> running{0};
+  std::atomic<int> peak{0};
+  const int result = Concurrency::execute([&] {
+    tbb::parallel_for(0, 64, [&](int) {
+      const int now = ++running;
+      int seen = peak.load();
+      while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+      }
+      --running;
+    });
+    return 7;
+  });
+  EXPECT_EQ(result, 7);
+  EXPECT_LE(peak.load(), static_cast<int>(Concurrency::getNumThreads()));
+
+  EXPECT_TRUE(Concurrency::configure(1));
+  EXPECT_FALSE(Concurrency::isParallel());
+  // An unknown NUMA node leaves the arena unpinned
+  EXPECT_FALSE(Concurrency::configure(1, 1 << 20));
+  EXPECT_EQ(Concurrency::getNumThreads(), 1u);
+  Concurrency::configure(0);
+}
@@ -0,0 +1,84 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include "PerfReport.h"
+
+using namespace KEPLER_FORMAL;
+
+TEST(PerfReportTests, PhasesAreWrittenAsJSON) {
+  // Probes are free and silent until the report is enabled
+  { PerfReport::Phase ignored("before_enable"); }
+  PerfReport::enable();
+  PerfReport::clear();
+  {
+    PerfReport::Phase phase("sat_solve");
+    phase.add("conflicts", 42).add("sat", 0);
+  }
+  PerfReport::Phase stopped("tseitin");
+  stopped.add("clauses", 1e6).stop();
+  stopped.stop();
+  PerfReport::record("name \"quoted\"\n", 0.5, {});
+
+  const std::string json = PerfReport::toJSON();
+  EXPECT_EQ(json.find("before_enable"), std::string::npos);
+  EXPECT_NE(json.find("\"version\": 1"), std::string::npos);
+  EXPECT_NE(json.find("{\"name\": \"sat_solve\""), std::string::npos);
+  EXPECT_NE(json.find("\"counters\": {\"conflicts\": 42, \"sat\": 0}"),
+            std::string::npos);
+  EXPECT_NE(json.find("\"clauses\": 1000000"), std::string::npos);
+  EXPECT_NE(json.find("\"name \\\"quoted\\\"\\u000a\""), std::string::npos);
+  // stop() records once, the destructor does not record again
+  EXPECT_EQ(json.find("tseitin"), json.rfind("tseitin"));
+  EXPECT_GT(PerfReport::getPeakRSSKB(), 0u);
+
+  const std::string path = "perf_report_test.json";
+  ASSERT_TRUE(PerfReport::write(path));
+  std::ifstream in(path);
+  std::stringstream content;
+  content << in.rdbuf();
+  EXPECT_NE(content.str().find("\"phases\": ["), std::string::npos);
+  std::remove(path.c_str());
+
+  PerfReport::clear();
+  EXPECT_NE(PerfReport::toJSON().find("\"phases\": []"), std::string::npos);
+}
+
+TEST(PerfReportTests, CallsAreListedUpToTheCap) {
+  PerfReport::enable();
+  PerfReport::clear();
+  {
+    PerfReport::Phase phase("cluster_solve");
+    phase.add("clusters", 2);
+    phase.addCall({{"vars", 10}, {"clauses", 25}});
+    phase.addCall({{"vars", 3}, {"clauses", 4}});
+  }
+  {
+    PerfReport::Phase phase("escalation");
+    for (size_t k = 0; k < PerfReport::kMaxCalls + 10; ++k) {
+      phase.addCall({{"conflicts", 1}});
+    }
+  }
+  { PerfReport::Phase phase("no_calls"); }
+
+  const std::string json = PerfReport::toJSON();
+  EXPECT_NE(json.find("\"counters\": {\"clusters\": 2, \"calls\": 2}, "
+                      "\"calls\": [{\"vars\": 10, \"clauses\": 25}, "
+                      "{\"vars\": 3, \"clauses\": 4}]}"),
+            std::string::npos);
+  // past the cap calls are counted, not listed
+  const std::string numCalls = std::to_string(PerfReport::kMaxCalls + 10);
+  EXPECT_NE(json.find("\"calls\": " + numCalls), std::string::npos);
+  size_t listed = 0;
+  for (size_t at = json.find("{\"conflicts\": 1}"); at != std::string::npos;
+       at = json.find("{\"conflicts\": 1}", at + 1)) {
+    ++listed;
+  }
+  EXPECT_EQ(listed, PerfReport::kMaxCalls);
+  EXPECT_NE(json.find("{\"name\": \"no_calls\""), std::string::npos);
+  EXPECT_EQ(json.find("\"calls\"", json.find("no_calls")), std::string::npos);
+  PerfReport::clear();
+}
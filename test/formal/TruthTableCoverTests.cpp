@@ -0,0 +1,104 @@
+// Copyright 2024-2026 keplertech.io
+// SPDX-License-Identifier: GPL-3.0-only
+
+#include "TruthTableCover.h"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace KEPLER_FORMAL;
+
+namespace {
+
+bool evalCover(const TruthTableCover& cover, uint64_t m) {
+  bool value = false;
+  for (const auto& c : cover.cubes) {
+    if ((m & c.pos) == c.pos && (m & c.neg) == 0) {
+      value = true;
+      break;
+    }
+  }
+  return value != cover.complemented;
+}
+
+bool tableBit(const std::vector<uint64_t>& words, uint64_t m) {
+  return (words[m / 64] >> (m % 64)) & 1;
+}
+
+}  // namespace
+
+TEST(TruthTableCoverTest, SimpleCells) {
+  // AND2: single cube
+  auto andCover = TruthTableCover::compute(2, {0x8});
+  ASSERT_EQ(andCover.cubes.size(), 1u);
+  EXPECT_FALSE(andCover.complemented);
+  EXPECT_EQ(andCover.cubes[0].pos, 0x3u);
+  EXPECT_EQ(andCover.cubes[0].neg, 0x0u);
+
+  // OR2: ties between on-set and off-set keep the on-set
+  auto orCover = TruthTableCover::compute(2, {0xE});
+  EXPECT_FALSE(orCover.complemented);
+  EXPECT_EQ(orCover.getNumLiterals(), 2u);
+
+  // AOI21 = !((a & b) | c): off-set "ab + c" beats on-set "!a!c + !b!c"
+  uint64_t aoi = 0;
+  for (uint64_t m = 0; m < 8; ++m) {
+    if (!(((m & 1) && ((m >> 1) & 1)) || ((m >> 2) & 1))) aoi |= uint64_t(1) << m;
+  }
+  auto aoiCover = TruthTableCover::compute(3, {aoi});
+  EXPECT_TRUE(aoiCover.complemented);
+  EXPECT_EQ(aoiCover.cubes.size(), 2u);
+  EXPECT_EQ(aoiCover.getNumLiterals(), 3u);
+
+  // MUX2 (s = input 2): two cubes instead of four minterms
+  uint64_t mux = 0;
+  for (uint64_t m = 0; m < 8; ++m) {
+    bool s = (m >> 2) & 1;
+    if (s ? ((m >> 1) & 1) : (m & 1)) mux |= uint64_t(1) << m;
+  }
+  auto muxCover = TruthTableCover::compute(3, {mux});
+  EXPECT_EQ(muxCover.cubes.size(), 2u);
+}
+
+TEST(TruthTableCoverTest, IgnoresNonSupportInputs) {
+  // f = input 1, over 4 inputs
+  uint64_t f = 0;
+  for (uint64_t m = 0; m < 16; ++m) {
+    if ((m >> 1) & 1) f |= uint64_t(1) << m;
+  }
+  auto cover = TruthTableCover::compute(4, {f});
+  ASSERT_EQ(cover.cubes.size(), 1u);
+  EXPECT_EQ(cover.cubes[0].pos | cover.cubes[0].neg, 0x2u);
+}
+
+TEST(TruthTableCoverTest, RandomTablesAreCovered) {
+  std::mt19937_64 rng(42);
+  for (uint32_t n = 0; n <= 9; ++n) {
+    for (int trial = 0; trial < 20; ++trial) {
+      const uint64_t rows = uint64_t(1) << n;
+      std::vector<uint64_t> words(n <= 6 ? 1 : (size_t(1) << (n - 6)));
+      for (auto& w : words) w = rng();
+      if (rows < 64) words[0] &= (uint64_t(1) << rows) - 1;
+      auto cover = TruthTableCover::compute(n, words);
+      for (uint64_t m = 0; m < rows; ++m) {
+        ASSERT_EQ(evalCover(cover, m), tableBit(words, m))
+            << "n=" << n << " trial=" << trial << " m=" << m;
+      }
+    }
+  }
+}
+
+TEST(TruthTableCoverTest, CacheSharesCovers) {
+  TruthTableCoverCache::destroy();
+  auto c0 = TruthTableCoverCache::get(2, {0x6});
+  auto c1 = TruthTableCoverCache::get(2, {0x6});
+  EXPECT_EQ(c0.get(), c1.get());
+  EXPECT_EQ(TruthTableCoverCache::size(), 1u);
+  EXPECT_EQ(TruthTableCoverCache::get(TruthTableCoverCache::kMaxVars + 1,
+                                      std::vector<uint64_t>()),
+            nullptr);
+  TruthTableCoverCache::destroy();
+  EXPECT_EQ(TruthTableCoverCache::size(), 0u);
+}
@@ -6,9 +6,15 @@
 
 #include "gtest/gtest.h"
 
+#include "AIGMiter.h"
+#include "AIGSweeper.h"
 #include "BuildPrimaryOutputClauses.h"
 #include "ConstantPropagation.h"
+#include "DNLSwitcher.h"
+#include "MiterResultCache.h"
+#include "MiterStimulus.h"
 #include "MiterStrategy.h"
+#include "SolveBudget.h"
 #include "NLLibraryTruthTables.h"
 #include "NLUniverse.h"
 #include "NetlistGraph.h"
@@ -995,4 +1001,291 @@ TEST(KeplerCliSubprocessTests, ExampleTestRun) {
   EXPECT_EQ(rc, EXIT_SUCCESS);
 }
 
+TEST(MiterResultCacheTests, SaveLoadRoundTrip) {
+  const std::string path = "miter_result_cache_test.txt";
+  MiterResultCache cache;
+  cache.set(0x1234, {0xaaaa, 0xbbbb, MiterResultCache::Verdict::Equivalent});
+  cache.set(0x5678, {0xcccc, 0xdddd, MiterResultCache::Verdict::Different});
+  ASSERT_TRUE(cache.save(path));
+
+  MiterResultCache loaded;
+  ASSERT_TRUE(loaded.load(path));
+  EXPECT_EQ(loaded.size(), 2u);
+  EXPECT_TRUE(loaded.isKnownEquivalent(0x1234, 0xaaaa, 0xbbbb));
+  // a changed cone in either design invalidates the verdict
+  EXPECT_FALSE(loaded.isKnownEquivalent(0x1234, 0xaaaa, 0xbbbc));
+  // only equivalent verdicts are reused
+  EXPECT_FALSE(loaded.isKnownEquivalent(0x5678, 0xcccc, 0xdddd));
+  EXPECT_EQ(loaded.find(0x9999), nullptr);
+  std::remove(path.c_str());
+  EXPECT_FALSE(loaded.load(path));
+  EXPECT_EQ(loaded.size(), 0u);
+}
+
+TEST(AIGSweeperTests, MergesInternalEquivalences) {
+  AIG aig;
+  AIG::Lit a = aig.createInput(2);
+  AIG::Lit b = aig.createInput(3);
+  AIG::Lit c = aig.createInput(4);
+  // the same XOR in two structures strash does not identify
+  AIG::Lit x0 = aig.createXor(a, b);
+  AIG::Lit x1 = aig.createAnd(AIG::negate(aig.createAnd(a, b)),
+                              aig.createOr(a, b));
+  ASSERT_NE(x0, x1);
+  std::vector<AIG::Lit> roots = {aig.createAnd(x0, c), aig.createAnd(x1, c),
+                                 aig.createOr(a, c), aig.createOr(b, c)};
+  AIGSweeper sweeper(aig);
+  AIG swept = sweeper.sweep(roots);
+  EXPECT_GT(sweeper.getNumProved(), 0u);
+  EXPECT_EQ(roots[0], roots[1]);
+  EXPECT_NE(roots[2], roots[3]);
+  EXPECT_LT(swept.getNumAnds(), aig.getNumAnds());
+}
+
+TEST(AIGSweeperTests, SplitsClassesOnCounterexamples) {
+  // Wide conjunctions look constant on random patterns; disproving them
+  // takes more counterexamples than one simulation word holds
+  AIG aig;
+  std::vector<AIG::Lit> inputs;
+  for (size_t v = 2; v < 202; ++v) {
+    inputs.push_back(aig.createInput(v));
+  }
+  std::vector<AIG::Lit> roots;
+  for (size_t i = 0; i + 12 <= inputs.size(); i += 2) {
+    AIG::Lit conjunction = inputs[i];
+    for (size_t j = i + 1; j < i + 12; ++j) {
+      conjunction = aig.createAnd(conjunction, inputs[j]);
+    }
+    roots.push_back(conjunction);
+  }
+  // and one equivalence to find among them
+  roots.push_back(aig.createXor(inputs[0], inputs[1]));
+  roots.push_back(aig.createAnd(
+      AIG::negate(aig.createAnd(inputs[0], inputs[1])),
+      aig.createOr(inputs[0], inputs[1])));
+  const std::vector<AIG::Lit> before = roots;
+  AIGSweeper sweeper(aig);
+  AIG swept = sweeper.sweep(roots);
+  EXPECT_GT(sweeper.getNumDisproved(), 64u);
+  EXPECT_EQ(sweeper.getNumProved(), 1u);
+  EXPECT_EQ(sweeper.getNumUndecided(), 0u);
+  EXPECT_EQ(roots[roots.size() - 2], roots.back());
+  for (size_t i = 0; i + 2 < roots.size(); ++i) {
+    EXPECT_NE(roots[i], AIG::kFalse);
+    for (size_t j = i + 1; j + 2 < roots.size(); ++j) {
+      EXPECT_NE(roots[i], roots[j]);
+    }
+  }
+}
+
+TEST(AIGMiterTests, ClustersBySupportAndBalancesOr) {
+  AIG aig;
+  AIG::Lit a = aig.createInput(2);
+  AIG::Lit b = aig.createInput(3);
+  AIG::Lit c = aig.createInput(4);
+  AIG::Lit d = aig.createInput(5);
+  // roots 0 and 2 share b, root 1 only reads c and d
+  std::vector<AIG::Lit> roots = {aig.createAnd(a, b), aig.createXor(c, d),
+                                 aig.createOr(b, AIG::negate(a)),
+                                 AIG::kFalse};
+  auto clusters = clusterBySupport(aig, roots);
+  ASSERT_EQ(clusters.size(), 2u);
+  EXPECT_EQ(clusters[0], (std::vector<size_t>{0, 2}));
+  EXPECT_EQ(clusters[1], (std::vector<size_t>{1}));
+
+  // 8 inputs ORed: 7 gates over 3 levels
+  std::vector<AIG::Lit> lits;
+  for (size_t v = 2; v < 10; ++v) {
+    lits.push_back(aig.createInput(v));
+  }
+  const size_t before = aig.getNumAnds();
+  std::vector<AIG::Lit> orRoot = {createBalancedOr(aig, lits)};
+  EXPECT_EQ(aig.getNumAnds() - before, 7u);
+  std::vector<AIG::Lit> map(aig.getNumNodes(), AIG::kNoLit);
+  AIG sub = extractCones(aig, orRoot, map);
+  EXPECT_EQ(sub.getNumInputs(), 8u);
+  EXPECT_EQ(sub.getNumAnds(), 7u);
+  uint32_t node = AIG::getNode(orRoot[0]);
+  size_t depth = 0;
+  while (sub.isAnd(node)) {
+    node = AIG::getNode(sub.getFanin0(node));
+    ++depth;
+  }
+  EXPECT_EQ(depth, 3u);
+  EXPECT_EQ(createBalancedOr(aig, {}), AIG::kFalse);
+}
+
+TEST(MiterStimulusTests, MinimizedCubeRoundTrip) {
+  AIG aig;
+  AIG::Lit a = aig.createInput(2);
+  AIG::Lit b = aig.createInput(3);
+  AIG::Lit c = aig.createInput(4);
+  // a & (b | c): with a=1 b=1 c=0, c is not needed
+  AIG::Lit f = aig.createAnd(a, aig.createOr(b, c));
+  InputCube cube = {{2, true}, {3, true}, {4, false}, {9, true}};
+  ASSERT_TRUE(evaluateCube(aig, f, cube));
+  minimizeCube(aig, f, cube);
+  EXPECT_EQ(cube, (InputCube{{2, true}, {3, true}}));
+  EXPECT_TRUE(evaluateCube(aig, f, cube));
+  EXPECT_FALSE(evaluateCube(aig, f, {{2, true}}));
+
+  const std::string path = "miter_stimulus_test.txt";
+  MiterStimulus stimulus;
+  stimulus.add({"u0/out[3]", {{"a", true}, {"r0/Q", false}}});
+  stimulus.add({"z", {}});
+  ASSERT_TRUE(stimulus.save(path));
+  MiterStimulus loaded;
+  ASSERT_TRUE(loaded.load(path));
+  ASSERT_EQ(loaded.size(), 2u);
+  EXPECT_EQ(loaded.getVectors()[0].output, "u0/out[3]");
+  EXPECT_EQ(loaded.getVectors()[0].inputs,
+            (std::vector<std::pair<std::string, bool>>{{"a", true},
+                                                       {"r0/Q", false}}));
+  EXPECT_TRUE(loaded.getVectors()[1].inputs.empty());
+  std::remove(path.c_str());
+  EXPECT_FALSE(loaded.load(path));
+  EXPECT_EQ(loaded.size(), 0u);
+}
+
+TEST_F(MiterTests, DNLSwitcherRebuildsOnSwitch) {
+  NLUniverse* univ = NLUniverse::create();
+  NLDB* db = NLDB::create(univ);
+  NLLibrary* designs =
+      NLLibrary::create(db, NLLibrary::Type::Standard, NLName("designs"));
+  SNLDesign* top0 =
+      SNLDesign::create(designs, SNLDesign::Type::Standard, NLName("top0"));
+  SNLScalarTerm::create(top0, SNLTerm::Direction::Input, NLName("in"));
+  SNLDesign* top1 =
+      SNLDesign::create(designs, SNLDesign::Type::Standard, NLName("top1"));
+  SNLScalarTerm::create(top1, SNLTerm::Direction::Input, NLName("a"));
+  SNLScalarTerm::create(top1, SNLTerm::Direction::Output, NLName("b"));
+  univ->setTopDesign(top0);
+  {
+    DNLSwitcher switcher;
+    const auto h0 = switcher.add(top0);
+    const auto h1 = switcher.add(top1);
+    EXPECT_EQ(switcher.getCurrent(), DNLSwitcher::kNoDesign);
+    const size_t terms0 = switcher.switchTo(h0).getNBterms();
+    switcher.switchTo(h0);
+    EXPECT_EQ(switcher.getNumBuilds(), 1u);
+    EXPECT_GT(switcher.switchTo(h1).getNBterms(), terms0);
+    EXPECT_EQ(univ->getTopDesign(), top1);
+    EXPECT_EQ(switcher.switchTo(h1).getNBterms(), naja::DNL::get()->getNBterms());
+    auto copy1 = switcher.copy(h1);
+    switcher.switchTo(h0);
+    EXPECT_EQ(switcher.getCurrent(), h0);
+    EXPECT_EQ(switcher.getNumBuilds(), 3u);
+    // the copy outlives the switch
+    EXPECT_GT(copy1->getNBterms(), terms0);
+    EXPECT_EQ(copy1->getTop().getTermIndexes().second -
+                  copy1->getTop().getTermIndexes().first + 1,
+              2u);
+  }
+  EXPECT_EQ(univ->getTopDesign(), top0);
+}
+
+TEST(AIGMiterTests, PartitionsBoundTheSupport) {
+  AIG aig;
+  std::vector<AIG::Lit> inputs;
+  for (size_t v = 2; v < 10; ++v) {
+    inputs.push_back(aig.createInput(v));
+  }
+  // a chain of roots over inputs (i, i + 1): one cluster of 8 inputs
+  std::vector<AIG::Lit> roots;
+  for (size_t i = 0; i + 1 < inputs.size(); ++i) {
+    roots.push_back(aig.createAnd(inputs[i], inputs[i + 1]));
+  }
+  ASSERT_EQ(clusterBySupport(aig, roots).size(), 1u);
+  EXPECT_EQ(partitionBySupport(aig, roots, 0).size(), 1u);
+  EXPECT_EQ(partitionBySupport(aig, roots, 8).size(), 1u);
+
+  auto parts = partitionBySupport(aig, roots, 3);
+  // roots (0, 1) share input 1, then (2, 3), (4, 5) and 6 on its own
+  ASSERT_EQ(parts.size(), 4u);
+  EXPECT_EQ(parts[0], (std::vector<size_t>{0, 1}));
+  EXPECT_EQ(parts[1], (std::vector<size_t>{2, 3}));
+  EXPECT_EQ(parts[3], (std::vector<size_t>{6}));
+  // a root wider than the bound still gets a part
+  std::vector<AIG::Lit> wide = {createBalancedOr(aig, inputs), roots[0]};
+  parts = partitionBySupport(aig, wide, 3);
+  ASSERT_EQ(parts.size(), 2u);
+  EXPECT_EQ(parts[0], (std::vector<size_t>{0}));
+}
+
+TEST(SolveBudgetTests, LimitsEscalateAndLeaveChecksUndecided) {
+  SolverLimits limits;
+  limits.conflicts = 10;
+  limits.seconds = 0.5;
+  EXPECT_EQ(limits.escalate(0).conflicts, 10);
+  EXPECT_EQ(limits.escalate(2).conflicts, 640);
+  EXPECT_EQ(limits.escalate(2).propagations, -1);
+  EXPECT_DOUBLE_EQ(limits.escalate(1).seconds, 4.0);
+  limits.conflicts = INT64_MAX / 2;
+  EXPECT_EQ(limits.escalate(1).conflicts, INT64_MAX);
+
+  // 8 pigeons in 7 holes: unsatisfiable, far beyond a few conflicts
+  constexpr int kPigeons = 8;
+  constexpr int kHoles = 7;
+  Glucose::SimpSolver S;
+  for (int v = 0; v < kPigeons * kHoles; ++v) {
+    S.newVar();
+  }
+  auto at = [&](int p, int h) { return Glucose::mkLit(p * kHoles + h); };
+  for (int p = 0; p < kPigeons; ++p) {
+    Glucose::vec<Glucose::Lit> clause;
+    for (int h = 0; h < kHoles; ++h) {
+      clause.push(at(p, h));
+    }
+    S.addClause(clause);
+  }
+  for (int h = 0; h < kHoles; ++h) {
+    for (int p = 0; p < kPigeons; ++p) {
+      for (int q = p + 1; q < kPigeons; ++q) {
+        S.addClause(~at(p, h), ~at(q, h));
+      }
+    }
+  }
+  Glucose::vec<Glucose::Lit> assumps;
+  SolverLimits tight;
+  tight.conflicts = 5;
+  EXPECT_EQ(SolveBudget(tight).solve(S, assumps, false), l_Undef);
+  // a caller's conflict budget tightens an unlimited one
+  EXPECT_EQ(SolveBudget(SolverLimits()).solve(S, assumps, false, 0, 5),
+            l_Undef);
+  // nothing is left of a spent total time
+  SolverLimits spent;
+  spent.totalSeconds = 1e-9;
+  const SolveBudget exhausted(spent);
+  EXPECT_TRUE(exhausted.isExhausted());
+  EXPECT_EQ(exhausted.solve(S, assumps, false), l_Undef);
+  // the watchdog of a generous time limit does not cut the check short
+  SolverLimits timed;
+  timed.seconds = 60;
+  EXPECT_EQ(SolveBudget(timed).solve(S, assumps, false), l_False);
+}
+
+TEST(MiterResultCacheTests, InputHashesFollowThePairing) {
+  using Path = std::pair<std::vector<NLName>, std::vector<NLID::DesignObjectID>>;
+  const Path common{{NLName("core")}, {1, 0}};
+  const Path x{{NLName("x_reg")}, {2, 0}};
+  const Path y{{NLName("y_reg")}, {2, 0}};
+  const Path w{{NLName("w_reg")}, {2, 0}};
+  // first run: x and y are found in one design each and paired
+  const auto run1 = BuildPrimaryOutputClauses::getPairedInputHashes(
+      {common, x}, {common, y});
+  // second run: w is added to design 0 and sorts first among its own
+  // inputs, so y is now paired with w and x has no partner
+  const auto run2 = BuildPrimaryOutputClauses::getPairedInputHashes(
+      {common, w, x}, {common, y});
+  ASSERT_EQ(run1.size(), 2u);
+  ASSERT_EQ(run2.size(), 3u);
+  EXPECT_EQ(run1[0], run2[0]);
+  // the cones reading y must not hash as in the first run
+  EXPECT_NE(run1[1], run2[1]);
+  EXPECT_NE(run1[1], run2[2]);
+  // pairings are ordered
+  EXPECT_NE(BuildPrimaryOutputClauses::getPairedInputHashes({x}, {y})[0],
+            BuildPrimaryOutputClauses::getPairedInputHashes({y}, {x})[0]);
+}
+
 // End of appended tests
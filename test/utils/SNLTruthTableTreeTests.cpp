@@ -2,10 +2,12 @@
 // SPDX-License-Identifier: GPL-3.0-only
 
 #include "SNLTruthTableTree.h"
+#include "CompiledTruthTableTree.h"
 #include "SNLTruthTable.h"
 
 #include <gtest/gtest.h>
 #include <bitset>
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <stdexcept>
@@ -277,7 +279,7 @@ TEST(SNLTruthTableTreeEvalTest, NullChildNodeThrowsViaIdMismatch) {
   auto child = std::make_shared<Node>(0u, &tree);
   child->type = Node::Type::Input;
   child->data.inputIndex = 0;
-  child->truthTable = SNLTruthTable();
+  child->setTruthTable(SNLTruthTable());
   uint32_t childId = tree.allocateNode(child);
 
   // Sanity: nodeFromId returns the child
@@ -289,7 +291,7 @@ TEST(SNLTruthTableTreeEvalTest, NullChildNodeThrowsViaIdMismatch) {
   // Parent: 1-input table with mask 0b01
   auto parent = std::make_shared<Node>(0u, &tree);
   parent->type = Node::Type::Table;
-  parent->truthTable = makeMaskTable(1, 0b01);
+  parent->setTruthTable(makeMaskTable(1, 0b01));
   parent->childrenIds.push_back(childId);
 
   tree.allocateNode(parent);
@@ -308,7 +310,7 @@ TEST(SNLTruthTableTreeApi_Additions, AllocateNodeAndEvalInput) {
   // Defensive: try to mark as Input (harmless) but do not rely on it.
   node->type = Node::Type::Input;
   node->data.inputIndex = 0;
-  node->truthTable = SNLTruthTable(); // attempt to clear arity
+  node->setTruthTable(SNLTruthTable()); // attempt to clear arity
 
   uint32_t id = tree.allocateNode(node);
   EXPECT_EQ(tree.nodeFromId(id).get(), node.get());
@@ -330,7 +332,7 @@ TEST(SNLTruthTableTreeApi_Additions, NodeFromId_NodeIdMismatch) {
   auto node = std::make_shared<Node>(0u, &tree);
   node->type = Node::Type::Input;
   node->data.inputIndex = 0;
-  node->truthTable = SNLTruthTable();
+  node->setTruthTable(SNLTruthTable());
   uint32_t id = tree.allocateNode(node);
 
   EXPECT_EQ(tree.nodeFromId(id).get(), node.get());
@@ -345,7 +347,7 @@ TEST(SNLTruthTableTreeEval_Additions, TableNodeChildrenCountMismatchThrows) {
 
   auto tableNode = std::make_shared<Node>(0u, &tree);
   tableNode->type = Node::Type::Table;
-  tableNode->truthTable = makeMaskTable(1, 0b01); // arity 1
+  tableNode->setTruthTable(makeMaskTable(1, 0b01)); // arity 1
   tree.allocateNode(tableNode);
 
   EXPECT_THROW(tableNode->eval({true}), std::logic_error);
@@ -356,7 +358,7 @@ TEST(SNLTruthTableTreeEval_Additions, InvalidChildIdThrows) {
 
   auto parent = std::make_shared<Node>(0u, &tree);
   parent->type = Node::Type::Table;
-  parent->truthTable = makeMaskTable(1, 0b01);
+  parent->setTruthTable(makeMaskTable(1, 0b01));
   parent->childrenIds.push_back(SNLTruthTableTree::kInvalidId);
 
   tree.allocateNode(parent);
@@ -369,7 +371,7 @@ TEST(SNLTruthTableTreeEval_Additions, NullChildNodeThrowsViaIdMismatch) {
   auto child = std::make_shared<Node>(0u, &tree);
   child->type = Node::Type::Input;
   child->data.inputIndex = 0;
-  child->truthTable = SNLTruthTable();
+  child->setTruthTable(SNLTruthTable());
   uint32_t childId = tree.allocateNode(child);
 
   EXPECT_EQ(tree.nodeFromId(childId).get(), child.get());
@@ -379,7 +381,7 @@ TEST(SNLTruthTableTreeEval_Additions, NullChildNodeThrowsViaIdMismatch) {
 
   auto parent = std::make_shared<Node>(0u, &tree);
   parent->type = Node::Type::Table;
-  parent->truthTable = makeMaskTable(1, 0b01);
+  parent->setTruthTable(makeMaskTable(1, 0b01));
   parent->childrenIds.push_back(childId);
   tree.allocateNode(parent);
 
@@ -392,12 +394,12 @@ TEST(SNLTruthTableTreeEval_Additions, InputChildIndexOutOfRangeThrows) {
   auto child = std::make_shared<Node>(0u, &tree);
   child->type = Node::Type::Input;
   child->data.inputIndex = 5; // out of range
-  child->truthTable = SNLTruthTable();
+  child->setTruthTable(SNLTruthTable());
   uint32_t childId = tree.allocateNode(child);
 
   auto parent = std::make_shared<Node>(0u, &tree);
   parent->type = Node::Type::Table;
-  parent->truthTable = makeMaskTable(1, 0b01);
+  parent->setTruthTable(makeMaskTable(1, 0b01));
   parent->childrenIds.push_back(childId);
   tree.allocateNode(parent);
 
@@ -411,12 +413,12 @@ TEST(SNLTruthTableTreeEval_Additions, EvaluatesInputChildAndReadsTableBit) {
   auto child = std::make_shared<Node>(0u, &tree);
   child->type = Node::Type::Input;
   child->data.inputIndex = 0;
-  child->truthTable = SNLTruthTable();
+  child->setTruthTable(SNLTruthTable());
   uint32_t childId = tree.allocateNode(child);
 
   auto parent = std::make_shared<Node>(0u, &tree);
   parent->type = Node::Type::Table;
-  parent->truthTable = makeMaskTable(1, 0b01); // bit0=true, bit1=false
+  parent->setTruthTable(makeMaskTable(1, 0b01)); // bit0=true, bit1=false
   parent->childrenIds.push_back(childId);
   tree.allocateNode(parent);
 
@@ -429,7 +431,7 @@ TEST(SNLTruthTableTreeAddChild_Additions, AddChildIdRejectsInvalidId) {
 
   auto parent = std::make_shared<Node>(0u, &tree);
   parent->type = Node::Type::Table;
-  parent->truthTable = makeMaskTable(0, 0);
+  parent->setTruthTable(makeMaskTable(0, 0));
   tree.allocateNode(parent);
 
   EXPECT_THROW(parent->addChildId(SNLTruthTableTree::kInvalidId), std::logic_error);
@@ -440,13 +442,13 @@ TEST(SNLTruthTableTreeAddChild_Additions, AddChildIdEstablishesParentChildRelati
 
   auto parent = std::make_shared<Node>(0u, &tree);
   parent->type = Node::Type::Table;
-  parent->truthTable = makeMaskTable(0, 0);
+  parent->setTruthTable(makeMaskTable(0, 0));
   uint32_t parentId = tree.allocateNode(parent);
 
   auto child = std::make_shared<Node>(0u, &tree);
   child->type = Node::Type::Input;
   child->data.inputIndex = 0;
-  child->truthTable = SNLTruthTable();
+  child->setTruthTable(SNLTruthTable());
   uint32_t childId = tree.allocateNode(child);
 
   EXPECT_TRUE(parent->childrenIds.empty());
@@ -471,19 +473,19 @@ TEST(SNLTruthTableTreePrintTest, PrintWithMultipleChildren) {
 
   auto parent = std::make_shared<Node>(0u, &tree);
   parent->type = Node::Type::Table;
-  parent->truthTable = makeMaskTable(2, 0b1110); // 2-input OR
+  parent->setTruthTable(makeMaskTable(2, 0b1110)); // 2-input OR
   uint32_t parentId = tree.allocateNode(parent);
 
   auto child1 = std::make_shared<Node>(0u, &tree);
   child1->type = Node::Type::Input;
   child1->data.inputIndex = 0;
-  child1->truthTable = SNLTruthTable();
+  child1->setTruthTable(SNLTruthTable());
   uint32_t child1Id = tree.allocateNode(child1);
 
   auto child2 = std::make_shared<Node>(0u, &tree);
   child2->type = Node::Type::Input;
   child2->data.inputIndex = 1;
-  child2->truthTable = SNLTruthTable();
+  child2->setTruthTable(SNLTruthTable());
   uint32_t child2Id = tree.allocateNode(child2);
 
   parent->addChildId(child1Id);
@@ -509,6 +511,110 @@ TEST(SNLTruthTableTreeSizeEvalTest, SizeAndEvalBehavior) {
   EXPECT_THROW(tree.eval({true, false}), std::invalid_argument);
 }
 
+TEST(SNLTruthTablePoolTest, EqualTablesShareOneEntry) {
+  const uint32_t and2 = SNLTruthTablePool::intern(makeMaskTable(2, 0b1000));
+  EXPECT_EQ(SNLTruthTablePool::intern(makeMaskTable(2, 0b1000)), and2);
+  EXPECT_NE(SNLTruthTablePool::intern(makeMaskTable(2, 0b1110)), and2);
+  EXPECT_NE(SNLTruthTablePool::intern(makeMaskTable(3, 0b1000)), and2);
+  EXPECT_EQ(SNLTruthTablePool::intern(SNLTruthTable()),
+            SNLTruthTablePool::kNoTable);
+  EXPECT_EQ(SNLTruthTablePool::get(and2).size(), 2u);
+  EXPECT_TRUE(SNLTruthTablePool::get(and2).bits().bit(3));
+  EXPECT_FALSE(SNLTruthTablePool::get(and2).bits().bit(2));
+
+  SNLTruthTableTree tree;
+  auto node = std::make_shared<Node>(0u, &tree);
+  node->type = Node::Type::Table;
+  node->setTruthTable(makeMaskTable(2, 0b1000));
+  EXPECT_EQ(node->tableIndex, and2);
+  EXPECT_EQ(&node->getTruthTable(), &SNLTruthTablePool::get(and2));
+}
+
+TEST(CompiledTruthTableTreeTest, MatchesNodeEval) {
+  SNLTruthTableTree tree;
+  std::vector<uint32_t> inputIds;
+  for (uint32_t i = 0; i < 4; ++i) {
+    auto input = std::make_shared<Node>(i, &tree);
+    inputIds.push_back(tree.allocateNode(input));
+  }
+  auto addTable = [&](naja::DNL::DNLID termid, uint32_t size, uint64_t mask,
+                      const std::vector<uint32_t>& children) {
+    auto table = std::make_shared<Node>(0u, &tree);
+    table->type = Node::Type::Table;
+    table->data.termid = termid;
+    table->setTruthTable(makeMaskTable(size, mask));
+    for (uint32_t c : children) table->childrenIds.push_back(c);
+    tree.allocateNode(table);
+    for (uint32_t c : children) {
+      tree.nodeFromId(c)->parentIds.push_back(table->nodeID);
+    }
+    return table;
+  };
+  auto and2 = addTable(100, 2, 0b1000, {inputIds[0], inputIds[1]});
+  auto xor2 = addTable(101, 2, 0b0110, {inputIds[1], inputIds[2]});
+  auto maj3 = addTable(102, 3, 0b11101000,
+                       {and2->nodeID, xor2->nodeID, inputIds[3]});
+  auto one = addTable(103, 1, 0b11, {inputIds[2]});
+  // 4-input parity over shared and constant operands
+  auto root = addTable(104, 4, 0x6996,
+                       {maj3->nodeID, inputIds[0], and2->nodeID, one->nodeID});
+
+  // ids are already canonical, finalize() must keep the wiring
+  tree.finalize();
+  EXPECT_EQ(root->childrenIds[2], and2->nodeID);
+  EXPECT_EQ(and2->getTruthTable().size(), 2u);
+
+  CompiledTruthTableTree compiled(*root);
+  EXPECT_EQ(compiled.getNumInputs(), 4u);
+  // the constant table is folded away
+  EXPECT_EQ(compiled.getNumInstructions(), 4u);
+  for (uint32_t m = 0; m < 16; ++m) {
+    std::vector<bool> in(4);
+    for (uint32_t i = 0; i < 4; ++i) in[i] = ((m >> i) & 1) != 0;
+    EXPECT_EQ(compiled.eval(in), root->eval(in)) << std::bitset<4>(m);
+  }
+
+  // more words than one block, to cover the tail
+  const size_t numWords = CompiledTruthTableTree::kBlockWords + 3;
+  std::vector<uint64_t> inputs(4 * numWords);
+  uint64_t state = 0x9e3779b97f4a7c15ULL;
+  for (auto& word : inputs) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    word = state;
+  }
+  std::vector<uint64_t> out(numWords);
+  compiled.evaluate(inputs.data(), numWords, out.data());
+  for (size_t p = 0; p < numWords * 64; ++p) {
+    std::vector<bool> in(4);
+    for (size_t i = 0; i < 4; ++i) {
+      in[i] = (inputs[i * numWords + p / 64] >> (p % 64)) & 1;
+    }
+    ASSERT_EQ(((out[p / 64] >> (p % 64)) & 1) != 0, root->eval(in))
+        << "pattern " << p;
+  }
+  EXPECT_THROW(compiled.eval({true}), std::out_of_range);
+}
+
+TEST(CompiledTruthTableTreeTest, PassThroughTree) {
+  SNLTruthTableTree tree(0, 0, SNLTruthTableTree::Node::Type::P);
+  CompiledTruthTableTree compiled(tree);
+  EXPECT_EQ(compiled.getNumInputs(), 1u);
+  EXPECT_EQ(compiled.getNumInstructions(), 0u);
+  EXPECT_TRUE(compiled.eval({true}));
+  EXPECT_FALSE(compiled.eval({false}));
+
+  // var-id mode: input row i is var id i + 2, var ids 0 and 1 are constants
+  CompiledTruthTableTree byVar(tree, std::vector<size_t>{5});
+  EXPECT_EQ(byVar.getNumInputs(), 4u);
+  EXPECT_TRUE(byVar.eval({false, false, false, true}));
+  EXPECT_FALSE(byVar.eval({true, true, true, false}));
+  CompiledTruthTableTree constant(tree, std::vector<size_t>{1});
+  EXPECT_EQ(constant.getNumInputs(), 0u);
+  EXPECT_TRUE(constant.eval({}));
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();